@@ -17,8 +17,11 @@
 */
 
 #include "benchmark.h"
+#include "misc.h"
 #include "numa.h"
+#include "position.h"
 
+#include <cassert>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
@@ -85,6 +88,18 @@ const std::vector<std::string> Defaults = {
     "1C2ka3/9/C1Nab1n2/p3p3p/6p2/9/P3P3P/3AB4/3p2c2/c1BAK4 w",
     "CnN1k1b2/c3a4/4ba3/9/2nr5/9/9/4C4/4A4/4KA3 w"
 };
+
+// Endgames whose material is known to be drawn, or to be on the way to it
+const std::vector<std::string> EndgamePositions = {
+    "2bakab2/9/9/9/4N4/9/9/9/4A4/4K4 w",
+    "2b1kab2/9/9/9/9/4C4/9/9/4A4/3K5 w",
+    "3ak4/9/4b4/9/9/9/4P4/9/9/4K4 w",
+    "2bakab2/9/9/9/9/9/9/4N4/9/R3K4 w",
+    "2bakab2/9/9/4n4/9/2C6/4P4/9/4A4/3AK4 w",
+    "3aka3/9/4b4/9/2N6/9/9/9/4A4/3K5 b",
+    "4k4/4a4/3a5/9/9/6P2/9/4B4/9/3AK4 w",
+    "3k5/9/9/9/9/9/9/9/4A4/2C1K4 w"
+};
 // clang-format on
 
 // clang-format off
@@ -375,6 +390,7 @@ namespace Stockfish::Benchmark {
 // bench                            : search default positions up to depth 13
 // bench 64 1 15                    : search default positions up to depth 15 (TT = 64MB)
 // bench 64 1 100000 default nodes  : search default positions for 100K nodes each
+// bench 16 1 14 endgames          : search endgame positions up to depth 14
 // bench 64 4 5000 current movetime : search current position with 4 threads for 5 sec
 // bench 16 1 5 blah perft          : run a perft 5 on positions in file "blah"
 std::vector<std::string> setup_bench(const std::string& currentFen, std::istream& is) {
@@ -394,6 +410,9 @@ std::vector<std::string> setup_bench(const std::string& currentFen, std::istream
     if (fenFile == "default")
         fens = Defaults;
 
+    else if (fenFile == "endgames")
+        fens = EndgamePositions;
+
     else if (fenFile == "current")
         fens.push_back(currentFen);
 
@@ -503,4 +522,50 @@ BenchmarkSetup setup_benchmark(std::istream& is) {
     return setup;
 }
 
+// Measures how fast positions are set up from FEN strings and from their
+// packed representation, over all the positions used by the speedtest. The
+// optional argument is the number of passes over these positions.
+void setup_throughput(std::istream& is) {
+
+    int passes;
+    if (!(is >> passes))
+        passes = 1000;
+
+    std::vector<std::string>    fens;
+    std::vector<PackedPosition> packed;
+    StateInfo                   st;
+    Position                    pos;
+
+    for (const auto& game : BenchmarkPositions)
+        for (const std::string& fen : game)
+        {
+            fens.push_back(fen);
+            packed.push_back(pos.set(fen, &st).pack());
+        }
+
+    Key fenSum = 0, packedSum = 0;
+
+    TimePoint fenTime = now();
+    for (int i = 0; i < passes; ++i)
+        for (const auto& fen : fens)
+            fenSum += pos.set(fen, &st).key();
+    fenTime = now() - fenTime + 1;
+
+    TimePoint packedTime = now();
+    for (int i = 0; i < passes; ++i)
+        for (const auto& pp : packed)
+            packedSum += pos.set_packed(pp, &st).key();
+    packedTime = now() - packedTime + 1;
+
+    assert(fenSum == packedSum);
+
+    const uint64_t total = uint64_t(passes) * fens.size();
+
+    std::cerr << "\n==========================="
+              << "\nPositions set up     : " << total
+              << "\nFEN setups/second    : " << 1000 * total / fenTime
+              << "\nPacked setups/second : " << 1000 * total / packedTime
+              << "\nSpeedup              : " << double(fenTime) / packedTime << std::endl;
+}
+
 }  // namespace Stockfish
@@ -0,0 +1,563 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2025 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "distributed.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+
+#include "misc.h"
+#include "tt.h"
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <unistd.h>
+
+    #ifndef MSG_NOSIGNAL
+        #define MSG_NOSIGNAL 0
+    #endif
+#endif
+
+namespace Stockfish::Distributed {
+
+namespace {
+
+constexpr auto     FlushPeriod    = std::chrono::milliseconds(10);
+constexpr int      ReconnectMs    = 1000;
+constexpr int      AcceptPollMs   = 100;      // Delay of stop() for the listener
+constexpr size_t   MaxBuffered    = 1 << 16;  // Entries waiting to be sent or applied
+constexpr size_t   MaxBatchLength = MaxBuffered;
+constexpr size_t   MaxPeers       = 64;          // Inbound connections, and instances in the vote
+constexpr uint32_t Magic          = 0x616B6950;  // "Pika"
+constexpr uint32_t Version        = 1;
+
+// FNV-1a, which unlike std::hash is the same on all platforms
+uint64_t digest(const std::string& s) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (unsigned char c : s)
+        h = (h ^ c) * 0x100000001B3ULL;
+    return h;
+}
+
+// Records come from the network, so those a search cannot have sent are dropped
+bool is_valid(const EntryRecord& e) {
+    return std::abs(e.value) <= VALUE_MATE
+        && (e.eval == VALUE_NONE || std::abs(e.eval) < VALUE_MATE_IN_MAX_PLY) && e.pvBound < 8
+        && Bound(e.pvBound & 3) != BOUND_NONE && e.depth > 0 && e.depth < MAX_PLY;
+}
+
+bool is_valid(const RootRecord& r) {
+    return std::abs(r.score) <= VALUE_MATE && r.depth > 0 && r.depth < MAX_PLY;
+}
+
+#if !defined(_WIN32)
+
+void close_socket(int fd) { close(fd); }
+void shutdown_socket(int fd) { shutdown(fd, SHUT_RDWR); }
+
+// Where send() has no MSG_NOSIGNAL, e.g. on macOS, the socket itself must not
+// raise SIGPIPE when the peer drops the connection, as that kills the engine.
+void disable_sigpipe([[maybe_unused]] int fd) {
+    #if defined(SO_NOSIGPIPE)
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &yes, sizeof(yes));
+    #endif
+}
+
+// A timeout of 0 waits forever
+void set_receive_timeout(int fd, int seconds) {
+    timeval timeout{seconds, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+}
+
+// Waits at most the given time for a connection, so that the listener can
+// notice it is stopped without shutdown() on its socket, which does not wake
+// up accept() on all systems.
+int accept_within(int listenFd, int ms) {
+    pollfd pfd{listenFd, POLLIN, 0};
+
+    if (poll(&pfd, 1, ms) != 1)
+        return -1;
+
+    // The socket is non-blocking in case the connection is gone by now, which
+    // the accepted one inherits on some systems.
+    int fd = accept(listenFd, nullptr, nullptr);
+    if (fd != -1)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+        disable_sigpipe(fd);
+    }
+    return fd;
+}
+
+bool send_all(int fd, const void* data, size_t len) {
+    for (auto p = static_cast<const char*>(data); len;)
+    {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n <= 0)
+            return false;
+        p += n, len -= size_t(n);
+    }
+    return true;
+}
+
+bool read_all(int fd, void* data, size_t len) {
+    for (auto p = static_cast<char*>(data); len;)
+    {
+        ssize_t n = recv(fd, p, len, 0);
+        if (n <= 0)
+            return false;
+        p += n, len -= size_t(n);
+    }
+    return true;
+}
+
+int listen_on(int port) {
+    int fd  = socket(AF_INET6, SOCK_STREAM, 0);
+    int yes = 1, no = 0;
+
+    if (fd == -1)
+        return -1;
+
+    // Accept both IPv4 and IPv6 connections
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &no, sizeof(no));
+
+    sockaddr_in6 addr{};
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr   = in6addr_any;
+    addr.sin6_port   = htons(uint16_t(port));
+
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 16) != 0
+        || fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int connect_to(const std::string& address) {
+    const size_t colon = address.rfind(':');
+    if (colon == std::string::npos)
+        return -1;
+
+    std::string host = address.substr(0, colon), port = address.substr(colon + 1);
+    if (host.size() > 1 && host.front() == '[' && host.back() == ']')
+        host = host.substr(1, host.size() - 2);
+
+    addrinfo  hints{};
+    addrinfo* res = nullptr;
+    hints.ai_socktype = SOCK_STREAM;
+
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0)
+        return -1;
+
+    int fd = -1;
+    for (addrinfo* ai = res; ai && fd == -1; ai = ai->ai_next)
+    {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd == -1)
+            continue;
+
+        // Bounds the time spent on connect() and on a stalled peer
+        timeval timeout{1, 0};
+        int     yes = 1;
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        disable_sigpipe(fd);
+
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) != 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    freeaddrinfo(res);
+    return fd;
+}
+
+#else
+
+// Sockets are only implemented for POSIX systems
+void close_socket(int) {}
+void shutdown_socket(int) {}
+void set_receive_timeout(int, int) {}
+int  accept_within(int, int) { return -1; }
+bool send_all(int, const void*, size_t) { return false; }
+bool read_all(int, void*, size_t) { return false; }
+int  listen_on(int) { return -1; }
+int  connect_to(const std::string&) { return -1; }
+
+#endif
+
+bool send_message(int fd, MessageType type, const void* records, size_t count, size_t size) {
+    const MessageHeader header{type, uint32_t(count)};
+    return send_all(fd, &header, sizeof(header)) && send_all(fd, records, count * size);
+}
+
+}  // namespace
+
+Node::Node(TranspositionTable& transpositionTable) :
+    tt(transpositionTable) {}
+
+Node::~Node() { stop(); }
+
+std::string Node::start(int                                 port,
+                        const std::string&                  peers,
+                        [[maybe_unused]] const std::string& sharedSecret,
+                        [[maybe_unused]] Depth              minEntryDepth,
+                        [[maybe_unused]] size_t             bandwidthKiB) {
+
+    stop();
+
+    std::string        address;
+    std::istringstream is(peers);
+
+    peerAddresses.clear();
+    while (std::getline(is >> std::ws, address, ','))
+    {
+        std::istringstream words(address);
+        while (words >> address)
+            peerAddresses.push_back(address);
+    }
+
+    if (!port && peerAddresses.empty())
+        return "Cluster mode off";
+
+#if defined(_WIN32)
+    return "Cluster mode is not supported on this platform";
+#else
+    std::string info;
+
+    if (port && sharedSecret.empty())
+        info = "Not listening without a ClusterSecret, ";
+    else if (port && (listenFd = listen_on(port)) == -1)
+        info = "Failed to listen on port " + std::to_string(port) + ", ";
+
+    minDepth  = minEntryDepth;
+    bandwidth = bandwidthKiB * 1024;
+    secret    = digest(sharedSecret);
+    nodeId    = PRNG(uint64_t(now()) ^ reinterpret_cast<uintptr_t>(this)).rand<uint64_t>();
+    running   = true;
+
+    if (listenFd != -1)
+        listener = std::thread(&Node::listen_loop, this);
+    sender = std::thread(&Node::send_loop, this);
+
+    return info + "Cluster mode with " + std::to_string(peerAddresses.size()) + " peer"
+         + (peerAddresses.size() == 1 ? "" : "s")
+         + (listenFd != -1 ? ", listening on port " + std::to_string(port) : "");
+#endif
+}
+
+void Node::stop() {
+
+    running  = false;
+    minDepth = Disabled;
+
+    if (listener.joinable())
+        listener.join();
+    if (sender.joinable())
+        sender.join();
+
+    // The listener has stopped, so no receiver can be added
+    for (auto& r : receivers)
+        shutdown_socket(r->fd);
+    for (auto& r : receivers)
+    {
+        r->thread.join();
+        close_socket(r->fd);
+    }
+
+    if (listenFd != -1)
+        close_socket(listenFd);
+
+    listenFd = -1;
+    receivers.clear();
+
+    for (Outbox& box : outboxes)
+    {
+        std::lock_guard<std::mutex> lk(box.mutex);
+        box.entries.clear();
+    }
+
+    std::lock_guard<std::mutex> lk(mutex);
+    incoming.clear();
+    peerRoots.clear();
+    rootPending    = false;
+    peersConnected = 0;
+    hasIncoming    = false;
+    entriesSent = entriesReceived = 0;
+}
+
+void Node::listen_loop() {
+
+    while (running)
+    {
+        // Reap the receivers of the connections closed since
+        for (auto it = receivers.begin(); it != receivers.end();)
+            if ((*it)->done)
+            {
+                (*it)->thread.join();
+                close_socket((*it)->fd);
+                it = receivers.erase(it);
+            }
+            else
+                ++it;
+
+        int fd = accept_within(listenFd, AcceptPollMs);
+
+        if (fd == -1)
+            continue;
+
+        if (receivers.size() >= MaxPeers)
+        {
+            close_socket(fd);
+            continue;
+        }
+
+        auto& r   = receivers.emplace_back(std::make_unique<Receiver>());
+        r->fd     = fd;
+        r->thread = std::thread(&Node::receive_loop, this, r.get());
+    }
+}
+
+void Node::receive_loop(Receiver* receiver) {
+
+    const int                fd = receiver->fd;
+    Handshake                hello;
+    MessageHeader            header;
+    std::vector<EntryRecord> batch;
+    RootRecord               root;
+
+    // Close the connections of other programs, versions or clusters. A peer
+    // is given a second to identify itself, while it may then wait for a
+    // search as long as it likes before sending anything.
+    set_receive_timeout(fd, 1);
+
+    const bool accepted = read_all(fd, &hello, sizeof(hello)) && hello.magic == Magic
+                       && hello.version == Version && hello.secret == secret;
+
+    set_receive_timeout(fd, 0);
+
+    while (accepted && read_all(fd, &header, sizeof(header)))
+    {
+        if (header.type == ENTRIES && header.count <= MaxBatchLength)
+        {
+            batch.resize(header.count);
+            if (!read_all(fd, batch.data(), batch.size() * sizeof(EntryRecord)))
+                break;
+
+            std::lock_guard<std::mutex> lk(mutex);
+            const size_t count = std::min(batch.size(), MaxBuffered - incoming.size());
+            incoming.insert(incoming.end(), batch.begin(), batch.begin() + count);
+            entriesReceived += count;
+            hasIncoming = !incoming.empty();
+        }
+        else if (header.type == ROOT && header.count == 1)
+        {
+            if (!read_all(fd, &root, sizeof(root)))
+                break;
+
+            std::lock_guard<std::mutex> lk(mutex);
+            if (is_valid(root) && (peerRoots.size() < MaxPeers || peerRoots.count(root.nodeId)))
+                peerRoots[root.nodeId] = root;
+        }
+        else
+            break;  // Corrupted stream
+    }
+
+    receiver->done = true;
+}
+
+void Node::send_loop() {
+
+    std::vector<int>         fds(peerAddresses.size(), -1);
+    std::vector<TimePoint>   lastAttempt(peerAddresses.size(), 0);
+    std::vector<EntryRecord> batch;
+    const Handshake          hello{Magic, Version, secret};
+
+    const size_t maxEntries = std::max(
+      size_t(1), bandwidth * size_t(FlushPeriod.count()) / 1000 / sizeof(EntryRecord));
+
+    while (running)
+    {
+        std::this_thread::sleep_for(FlushPeriod);
+
+        bool       sendRoot = false;
+        RootRecord root;
+        size_t     connected = 0;
+
+        for (size_t i = 0; i < fds.size(); ++i)
+            if (fds[i] == -1 && now() - lastAttempt[i] >= ReconnectMs)
+            {
+                lastAttempt[i] = now();
+                fds[i]         = connect_to(peerAddresses[i]);
+
+                if (fds[i] != -1 && !send_all(fds[i], &hello, sizeof(hello)))
+                {
+                    close_socket(fds[i]);
+                    fds[i] = -1;
+                }
+                sendRoot |= fds[i] != -1;  // Bring the new peer up to date
+            }
+
+        batch.clear();
+        for (Outbox& box : outboxes)
+        {
+            std::lock_guard<std::mutex> lk(box.mutex);
+            batch.insert(batch.end(), box.entries.begin(), box.entries.end());
+            box.entries.clear();
+        }
+
+        {
+            std::lock_guard<std::mutex> lk(mutex);
+            sendRoot |= rootPending;
+            root        = rootOut;
+            rootPending = false;
+        }
+
+        // Keep the deepest entries within the bandwidth
+        if (batch.size() > maxEntries)
+        {
+            std::nth_element(batch.begin(), batch.begin() + maxEntries, batch.end(),
+                             [](const EntryRecord& a, const EntryRecord& b) {
+                                 return a.depth > b.depth;
+                             });
+            batch.resize(maxEntries);
+        }
+
+        for (int& fd : fds)
+        {
+            if (fd == -1)
+                continue;
+
+            if ((sendRoot && root.move && !send_message(fd, ROOT, &root, 1, sizeof(root)))
+                || (!batch.empty()
+                    && !send_message(fd, ENTRIES, batch.data(), batch.size(), sizeof(EntryRecord))))
+            {
+                close_socket(fd);
+                fd = -1;
+                continue;
+            }
+
+            connected++;
+            entriesSent += batch.size();
+        }
+
+        std::lock_guard<std::mutex> lk(mutex);
+        peersConnected = connected;
+    }
+
+    for (int fd : fds)
+        if (fd != -1)
+            close_socket(fd);
+}
+
+void Node::share_entry(
+  size_t threadIdx, Key k, Value v, bool pv, Bound b, Depth d, Move m, Value ev) {
+
+    Outbox&                     box = outboxes[threadIdx % Outboxes];
+    std::lock_guard<std::mutex> lk(box.mutex);
+
+    if (box.entries.size() < MaxBuffered / Outboxes)
+        box.entries.push_back(
+          {k, int16_t(v), int16_t(ev), m.raw(), uint8_t(d), uint8_t(pv << 2 | b)});
+}
+
+void Node::share_root(const RootResult& result) {
+
+    std::lock_guard<std::mutex> lk(mutex);
+
+    rootOut     = {nodeId, result.rootKey, result.score, result.depth, result.move.raw(), {}};
+    rootPending = true;
+}
+
+void Node::apply_received() {
+
+    if (!hasIncoming.load(std::memory_order_relaxed))
+        return;
+
+    std::vector<EntryRecord> batch;
+    {
+        std::lock_guard<std::mutex> lk(mutex);
+        batch.swap(incoming);
+        hasIncoming = false;
+    }
+
+    for (const EntryRecord& e : batch)
+    {
+        if (!is_valid(e))
+            continue;
+
+        auto [ttHit, ttData, ttWriter] = tt.probe(e.key);
+
+        // Keep the local result of a search at least as deep
+        if (!ttHit || ttData.depth < e.depth)
+            ttWriter.write(e.key, Value(e.value), e.pvBound >> 2, Bound(e.pvBound & 3), e.depth,
+                           Move(e.move), Value(e.eval), tt.generation());
+    }
+}
+
+Move Node::vote(const RootResult& local) const {
+
+    std::vector<RootResult> results{local};
+    {
+        std::lock_guard<std::mutex> lk(mutex);
+        for (const auto& [id, r] : peerRoots)
+            if (r.rootKey == local.rootKey && r.move)
+                results.push_back({r.rootKey, Move(r.move), Value(r.score), Depth(r.depth)});
+    }
+
+    Value minScore = VALUE_NONE;
+    for (const auto& r : results)
+        minScore = std::min(minScore, r.score);
+
+    std::map<uint16_t, int64_t> votes;
+    for (const auto& r : results)
+        votes[r.move.raw()] += int64_t(r.score - minScore + 14) * r.depth;
+
+    Move best = local.move;
+    for (const auto& r : results)
+        if (votes[r.move.raw()] > votes[best.raw()])
+            best = r.move;
+
+    return best;
+}
+
+std::string Node::stats() const {
+
+    std::lock_guard<std::mutex> lk(mutex);
+
+    return "Cluster: " + std::to_string(peersConnected) + " of "
+         + std::to_string(peerAddresses.size()) + " peers connected, sent "
+         + std::to_string(entriesSent) + " entries, received " + std::to_string(entriesReceived)
+         + " entries";
+}
+
+}  // namespace Stockfish::Distributed
@@ -0,0 +1,180 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2025 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DISTRIBUTED_H_INCLUDED
+#define DISTRIBUTED_H_INCLUDED
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "types.h"
+
+namespace Stockfish {
+
+class TranspositionTable;
+
+// Spreads a search over several engine instances, usually on different
+// machines, which send each other their deep transposition table entries and
+// their results at the root over TCP. Each instance searches the root on its
+// own with the help of these entries, and picks its best move by a vote over
+// the results of all the instances, like the threads of one instance do.
+namespace Distributed {
+
+// The wire format, in the byte order of the machines: a handshake on opening
+// the connection, then messages made of a header and count records of the type
+// given by the header.
+struct Handshake {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t secret;  // Digest of the secret shared by the instances
+};
+
+enum MessageType : uint32_t {
+    ENTRIES = 1,
+    ROOT    = 2
+};
+
+struct MessageHeader {
+    uint32_t type;
+    uint32_t count;
+};
+
+struct EntryRecord {
+    uint64_t key;
+    int16_t  value;
+    int16_t  eval;
+    uint16_t move;
+    uint8_t  depth;
+    uint8_t  pvBound;  // pv << 2 | bound
+};
+
+struct RootRecord {
+    uint64_t nodeId;  // Random, identifies the sending instance
+    uint64_t rootKey;
+    int32_t  score;
+    int32_t  depth;
+    uint16_t move;
+    uint16_t padding[3];
+};
+
+static_assert(sizeof(Handshake) == 16 && sizeof(EntryRecord) == 16 && sizeof(RootRecord) == 32,
+              "Unexpected padding");
+
+// The result of an instance at the root
+struct RootResult {
+    Key   rootKey;
+    Move  move;
+    Value score;
+    Depth depth;
+};
+
+class Node {
+   public:
+    explicit Node(TranspositionTable& transpositionTable);
+    ~Node();
+
+    // Listens on the given port, unless 0, and sends to the instances at the
+    // given addresses, as host:port separated by commas or spaces. Only the
+    // connections of instances with the same secret are accepted, so there is
+    // no listening without one. At most bandwidth KiB per second are sent to
+    // each peer, the deepest entries first. Returns a description of the setup.
+    std::string start(int                port,
+                      const std::string& peers,
+                      const std::string& secret,
+                      Depth              minEntryDepth,
+                      size_t             bandwidthKiB);
+    void stop();
+
+    bool active() const { return running.load(std::memory_order_relaxed); }
+
+    // Entries from shallower searches are not worth sending
+    Depth min_depth() const { return minDepth; }
+
+    void share_entry(size_t threadIdx, Key k, Value v, bool pv, Bound b, Depth d, Move m, Value ev);
+    void share_root(const RootResult& result);
+
+    // Writes the entries received since the last call to the transposition table.
+    // Called by the main search thread only, so that the table cannot be resized.
+    void apply_received();
+
+    // Votes among the local result and the latest ones of the other instances
+    // for the same root, according to score and depth.
+    Move vote(const RootResult& local) const;
+
+    std::string stats() const;
+
+   private:
+    static constexpr Depth  Disabled = std::numeric_limits<Depth>::max();
+    static constexpr size_t Outboxes = 64;
+
+    // The entries of a search thread waiting to be sent. Threads only share an
+    // outbox beyond Outboxes threads.
+    struct alignas(64) Outbox {
+        std::mutex               mutex;
+        std::vector<EntryRecord> entries;
+    };
+
+    // An inbound connection, reaped by the listener once closed
+    struct Receiver {
+        int               fd;
+        std::thread       thread;
+        std::atomic<bool> done{false};
+    };
+
+    void listen_loop();
+    void receive_loop(Receiver* receiver);
+    void send_loop();
+
+    TranspositionTable&      tt;
+    std::vector<std::string> peerAddresses;
+    Depth                    minDepth  = Disabled;
+    size_t                   bandwidth = 0;  // Bytes per second sent to each peer
+    uint64_t                 nodeId    = 0;
+    uint64_t                 secret    = 0;
+    std::atomic<bool>        running{false};
+    int                      listenFd = -1;
+
+    std::thread                            listener, sender;
+    std::vector<std::unique_ptr<Receiver>> receivers;  // Owned by the listener
+    std::array<Outbox, Outboxes>           outboxes;
+
+    mutable std::mutex             mutex;  // Guards the buffer and the state below
+    std::vector<EntryRecord>       incoming;
+    RootRecord                     rootOut{};
+    bool                           rootPending = false;
+    std::map<uint64_t, RootRecord> peerRoots;
+    size_t                         peersConnected = 0;
+
+    std::atomic<bool>     hasIncoming{false};
+    std::atomic<uint64_t> entriesSent{0}, entriesReceived{0};
+};
+
+}  // namespace Distributed
+
+}  // namespace Stockfish
+
+#endif  // #ifndef DISTRIBUTED_H_INCLUDED
@@ -0,0 +1,127 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2025 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ENDGAME_H_INCLUDED
+#define ENDGAME_H_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "position.h"
+#include "types.h"
+
+namespace Stockfish::Endgames {
+
+// What the material on the board tells about the result of the game, from the
+// point of view of the side to move. The verdicts are not sound enough to cut
+// the search: they only scale the evaluation towards a draw.
+enum Verdict : uint8_t {
+    NO_VERDICT  = 0,
+    CANNOT_WIN  = 1,
+    CANNOT_LOSE = 2,
+    DRAWN       = CANNOT_WIN | CANNOT_LOSE
+};
+
+// The attacking material of a side, i.e. what can cross the river, is summed
+// up in a class, and completed with the number of advisors and bishops into
+// the material index of the side.
+enum AttackerClass : int {
+    NO_ATTACKER,
+    LONE_KNIGHT,
+    LONE_CANNON,
+    LONE_PAWN,
+    MORE_ATTACKERS,
+    ATTACKER_CLASS_NB
+};
+
+constexpr int MATERIAL_INDEX_NB = ATTACKER_CLASS_NB * 3 * 3;
+
+constexpr AttackerClass attacker_class(int rooks, int knights, int cannons, int pawns) {
+    const int attackers = rooks + knights + cannons + pawns;
+
+    if (attackers == 0)
+        return NO_ATTACKER;
+    if (attackers > 1 || rooks)
+        return MORE_ATTACKERS;
+    return knights ? LONE_KNIGHT : cannons ? LONE_CANNON : LONE_PAWN;
+}
+
+constexpr int
+material_index(int rooks, int knights, int cannons, int pawns, int advisors, int bishops) {
+    return (attacker_class(rooks, knights, cannons, pawns) * 3 + std::min(advisors, 2)) * 3
+         + std::min(bishops, 2);
+}
+
+static_assert(material_index(0, 0, 0, 0, 0, 0) == 0, "Material index must start at 0");
+static_assert(material_index(2, 2, 2, 5, 2, 2) == MATERIAL_INDEX_NB - 1,
+              "Material index must fit in MATERIAL_INDEX_NB");
+
+// Tells whether the side with the first material index can hardly win against
+// the second. A side with no attacking material can only win by stalemate or by
+// the repetition rules. The others are drawn in 99-100% of the positions of the
+// tablebases, but only when the defending side is to move: otherwise a loose
+// defender may be captured first, which leaves a different material signature.
+constexpr bool cannot_win(int attacker, int defender, bool attackerToMove) {
+    const int cls       = attacker / 9;
+    const int advisors  = attacker / 3 % 3;
+    const int defenders = defender / 3 % 3 + defender % 3;
+
+    if (cls == NO_ATTACKER)
+        return true;
+
+    if (attackerToMove)
+        return false;
+
+    switch (cls)
+    {
+    case LONE_KNIGHT :  // e.g. KNAvKBB, KNvKAA
+        return defenders >= 2;
+    case LONE_CANNON :  // e.g. KCBvKA, KCAvKBB
+        return advisors == 0 || (advisors == 1 && defender % 3 == 2);
+    case LONE_PAWN :  // e.g. KPAvKAA, KPvKAB
+        return advisors <= 1 && defenders >= 2;
+    default :
+        return false;
+    }
+}
+
+// Verdicts indexed by the material index of the side to move, then of the other side
+constexpr auto Verdicts = [] {
+    std::array<std::array<Verdict, MATERIAL_INDEX_NB>, MATERIAL_INDEX_NB> v{};
+
+    for (int us = 0; us < MATERIAL_INDEX_NB; ++us)
+        for (int them = 0; them < MATERIAL_INDEX_NB; ++them)
+            v[us][them] = Verdict((cannot_win(us, them, true) ? CANNOT_WIN : NO_VERDICT)
+                                  | (cannot_win(them, us, false) ? CANNOT_LOSE : NO_VERDICT));
+    return v;
+}();
+
+inline int material_index(const Position& pos, Color c) {
+    return material_index(pos.count<ROOK>(c), pos.count<KNIGHT>(c), pos.count<CANNON>(c),
+                          pos.count<PAWN>(c), pos.count<ADVISOR>(c), pos.count<BISHOP>(c));
+}
+
+inline Verdict probe(const Position& pos) {
+    const Color us = pos.side_to_move();
+    return Verdicts[material_index(pos, us)][material_index(pos, ~us)];
+}
+
+}  // namespace Stockfish::Endgames
+
+#endif  // #ifndef ENDGAME_H_INCLUDED
@@ -18,6 +18,7 @@
 
 #include "engine.h"
 
+#include <algorithm>
 #include <cassert>
 #include <deque>
 #include <memory>
@@ -27,11 +28,13 @@
 #include <vector>
 
 #include "evaluate.h"
+#include "memory.h"
 #include "misc.h"
 #include "nnue/network.h"
 #include "perft.h"
 #include "position.h"
 #include "search.h"
+#include "tablebase.h"
 #include "types.h"
 #include "uci.h"
 #include "ucioption.h"
@@ -43,12 +46,16 @@ namespace NN = Eval::NNUE;
 constexpr auto StartFEN  = "rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR w";
 constexpr int  MaxHashMB = Is64Bit ? 33554432 : 2048;
 
-Engine::Engine(std::optional<std::string> path) :
+Engine::Engine(std::optional<std::string> path, bool fastStart) :
     binaryDirectory(path ? CommandLine::get_binary_directory(*path) : ""),
+    startupDeferred(fastStart),
     numaContext(NumaConfig::from_system()),
     states(new std::deque<StateInfo>(1)),
     threads(),
-    network(numaContext, NN::Network({EvalFileDefaultName, "None", ""})) {
+    network(numaContext, NN::Network({EvalFileDefaultName, "None", ""})),
+    cluster(tt) {
+    StartupTimer optionsTimer("Engine options");
+
     pos.set(StartFEN, &states->back());
 
     options.add("Debug Log File", Option("", [](const Option& o) {
@@ -67,11 +74,33 @@ Engine::Engine(std::optional<std::string> path) :
                     return thread_allocation_information_as_string();
                 }));
 
+    options.add("SharedHistory", Option(false, [this](const Option&) {
+                    resize_threads();
+                    return thread_allocation_information_as_string();
+                }));
+
     options.add("Hash", Option(16, 1, MaxHashMB, [this](const Option& o) {
                     set_tt_size(o);
                     return std::nullopt;
                 }));
 
+    options.add("MateHash", Option(16, 1, MaxHashMB, [this](const Option& o) {
+                    set_mate_table_size(o);
+                    return std::nullopt;
+                }));
+
+    options.add("SharedHash", Option("", [this](const Option&) {
+                    set_tt_size(options["Hash"]);
+                    return std::optional<std::string>("Hash backing: " + get_hash_backing());
+                }));
+
+    options.add("LargePages", Option("auto", [this](const Option& o) {
+                    set_large_pages_from_option(o);
+                    return large_pages_information_as_string();
+                }));
+
+    options.add("TTProbeAhead", Option(0, 0, 2));
+
     options.add("Clear Hash", Option([this](const Option&) {
                     search_clear();
                     return std::nullopt;
@@ -92,8 +121,38 @@ Engine::Engine(std::optional<std::string> path) :
                     return std::nullopt;
                 }));
 
+    options.add("TablebasePath", Option("", [](const Option& o) {
+                    return std::optional<std::string>(Tablebases::init(o));
+                }));
+
+    options.add("TablebaseProbeDepth", Option(1, 1, 100));
+
+    options.add("ClusterPort", Option(0, 0, 65535, [this](const Option&) {
+                    return std::optional<std::string>(set_cluster_from_options());
+                }));
+
+    options.add("ClusterPeers", Option("", [this](const Option&) {
+                    return std::optional<std::string>(set_cluster_from_options());
+                }));
+
+    options.add("ClusterSecret", Option("", [this](const Option&) {
+                    return std::optional<std::string>(set_cluster_from_options());
+                }));
+
+    options.add("ClusterMinDepth", Option(10, 1, MAX_PLY - 1, [this](const Option&) {
+                    return std::optional<std::string>(set_cluster_from_options());
+                }));
+
+    options.add("ClusterBandwidth", Option(1024, 1, 1 << 20, [this](const Option&) {
+                    return std::optional<std::string>(set_cluster_from_options());
+                }));
+
+    optionsTimer.stop();
+
     load_network(options["EvalFile"]);
+    Tablebases::init(options["TablebasePath"]);
     resize_threads();
+    set_tt_size(options["Hash"]);
 }
 
 std::uint64_t Engine::perft(const std::string& fen, Depth depth) {
@@ -105,11 +164,27 @@ std::uint64_t Engine::perft(const std::string& fen, Depth depth) {
 void Engine::go(Search::LimitsType& limits) {
     assert(limits.perft == 0);
     verify_network();
+    ensure_ready();
 
     threads.start_thinking(pos, states, limits);
 }
 void Engine::stop() { threads.stop = true; }
 
+void Engine::ensure_ready() {
+    if (!startupDeferred)
+        return;
+
+    wait_for_search_finished();
+    startupDeferred = false;
+
+    StartupTimer zeroing("deferred hash zeroing");
+    tt.ensure_zeroed(threads);
+    zeroing.stop();
+
+    StartupTimer replication("deferred network replication");
+    threads.ensure_network_replicated();
+}
+
 void Engine::search_clear() {
     wait_for_search_finished();
 
@@ -139,26 +214,68 @@ void Engine::set_on_verify_networks(std::function<void(std::string_view)>&& f) {
 
 void Engine::wait_for_search_finished() { threads.main_thread()->wait_for_search_finished(); }
 
+void Engine::generate(const TrainingData::GenerateSetup& setup) {
+    wait_for_search_finished();
+
+    TrainingData::GenerateSetup s = setup;
+    if (!s.concurrency)
+        s.concurrency = options["Threads"];
+
+    TrainingData::generate(s, options, network);
+}
+
+void Engine::rescore(const TrainingData::RescoreSetup& setup) {
+    wait_for_search_finished();
+
+    TrainingData::rescore(setup, options, threads, network);
+}
+
+void Engine::generate_tablebase(const std::string& signature, const std::string& directory) {
+    wait_for_search_finished();
+
+    Tablebases::generate(signature, directory, size_t(options["Threads"]));
+}
+
 void Engine::set_position(const std::string& fen, const std::vector<std::string>& moves) {
-    // Drop the old state and create a new one
-    states = StateListPtr(new std::deque<StateInfo>(1));
-    pos.set(fen, &states->back());
+    size_t ply = 0;
+
+    // When the new move list only extends the one of the current position, as
+    // GUIs do during a game, keep the existing states and play just the suffix.
+    // After a 'go' the states are owned by the thread pool, so they can only be
+    // taken back if no search is still reading them.
+    if (fen == positionFen && moves.size() >= positionMoves.size()
+        && std::equal(positionMoves.begin(), positionMoves.end(), moves.begin())
+        && (states || (states = threads.reclaim_setup_states())))
+        ply = positionMoves.size();
+    else
+    {
+        // Drop the old state and create a new one
+        states = StateListPtr(new std::deque<StateInfo>(1));
+        pos.set(fen, &states->back());
+
+        positionFen = fen;
+        positionMoves.clear();
+    }
 
-    for (const auto& move : moves)
+    for (; ply < moves.size(); ++ply)
     {
-        auto m = UCIEngine::to_move(pos, move);
+        auto m = UCIEngine::to_move(pos, moves[ply]);
 
         if (m == Move::none())
             break;
 
         states->emplace_back();
         pos.do_move(m, states->back());
+        positionMoves.push_back(moves[ply]);
     }
 }
 
 // modifiers
 
 void Engine::set_numa_config_from_option(const std::string& o) {
+    const std::string oldConfig  = get_numa_config_as_string();
+    const auto        oldBinding = threads.get_bound_thread_count_by_numa_node();
+
     if (o == "auto" || o == "system")
     {
         numaContext.set_numa_config(NumaConfig::from_system());
@@ -180,20 +297,72 @@ void Engine::set_numa_config_from_option(const std::string& o) {
     // Force reallocation of threads in case affinities need to change.
     resize_threads();
     threads.ensure_network_replicated();
+
+    // The pages of the hash were first touched by the threads of the previous
+    // binding, so only reallocate it when the threads are now placed differently.
+    if (get_numa_config_as_string() != oldConfig
+        || threads.get_bound_thread_count_by_numa_node() != oldBinding)
+        set_tt_size(options["Hash"]);
 }
 
-void Engine::resize_threads() {
-    threads.wait_for_search_finished();
-    threads.set(numaContext.get_numa_config(), {options, threads, tt, network}, updateContext);
+void Engine::set_large_pages_from_option(const std::string& o) {
+    if (o == "auto")
+        set_large_pages_mode(LARGE_PAGES_AUTO);
+    else if (o == "thp")
+        set_large_pages_mode(LARGE_PAGES_THP);
+    else if (o == "hugetlb-2m")
+        set_large_pages_mode(LARGE_PAGES_HUGETLB_2M);
+    else if (o == "hugetlb-1g")
+        set_large_pages_mode(LARGE_PAGES_HUGETLB_1G);
+    else if (o == "off")
+        set_large_pages_mode(LARGE_PAGES_OFF);
+    else
+        return;
 
-    // Reallocate the hash with the new threadpool size
+    // The mode only applies to new allocations, so reallocate the hash and
+    // copy the network into freshly allocated memory.
     set_tt_size(options["Hash"]);
+    network.modify_and_replicate(
+      [](NN::Network& network_) { network_ = NN::Network(std::as_const(network_)); });
+    threads.clear();
     threads.ensure_network_replicated();
 }
 
+void Engine::resize_threads() {
+    threads.wait_for_search_finished();
+
+    StartupTimer timer("ThreadPool::set");
+    threads.set(numaContext.get_numa_config(), {options, threads, tt, network, cluster},
+                updateContext);
+    timer.stop();
+
+    // The mate solver lives in the main manager, which has just been replaced
+    set_mate_table_size(options["MateHash"]);
+
+    if (!startupDeferred)
+    {
+        StartupTimer replication("network replication");
+        threads.ensure_network_replicated();
+    }
+}
+
 void Engine::set_tt_size(size_t mb) {
     wait_for_search_finished();
-    tt.resize(mb, threads);
+
+    StartupTimer timer("TranspositionTable::resize");
+    tt.resize(mb, threads, options["SharedHash"], startupDeferred);
+}
+
+void Engine::set_mate_table_size(size_t mb) {
+    wait_for_search_finished();
+    threads.main_manager()->mateSolver.resize(mb);
+}
+
+std::string Engine::set_cluster_from_options() {
+    wait_for_search_finished();
+    return cluster.start(int(options["ClusterPort"]), options["ClusterPeers"],
+                         options["ClusterSecret"], int(options["ClusterMinDepth"]),
+                         size_t(int(options["ClusterBandwidth"])));
 }
 
 void Engine::set_ponderhit(bool b) { threads.main_manager()->ponder = b; }
@@ -203,10 +372,15 @@ void Engine::set_ponderhit(bool b) { threads.main_manager()->ponder = b; }
 void Engine::verify_network() const { network->verify(options["EvalFile"], onVerifyNetworks); }
 
 void Engine::load_network(const std::string& file) {
+    StartupTimer timer("Network::load");
     network.modify_and_replicate(
       [this, &file](NN::Network& network_) { network_.load(binaryDirectory, file); });
+    timer.stop();
+
     threads.clear();
-    threads.ensure_network_replicated();
+
+    if (!startupDeferred)
+        threads.ensure_network_replicated();
 }
 
 void Engine::save_network(const std::optional<std::string>& file) {
@@ -230,7 +404,32 @@ OptionsMap&       Engine::get_options() { return options; }
 
 std::string Engine::fen() const { return pos.fen(); }
 
-void Engine::flip() { pos.flip(); }
+// A position command setting up the current position, with the moves from the
+// last position command so that repetitions can be told. Only what was applied
+// is included, which leaves out illegal moves.
+std::string Engine::position_command() const {
+    if (positionFen.empty())
+        return "position fen " + pos.fen();
+
+    std::string command = "position fen " + positionFen;
+
+    if (!positionMoves.empty())
+    {
+        command += command.back() == ' ' ? "moves" : " moves";
+        for (const auto& move : positionMoves)
+            command += " " + move;
+    }
+
+    return command;
+}
+
+void Engine::flip() {
+    pos.flip();
+
+    // The flipped position no longer matches the last 'position' command
+    positionFen.clear();
+    positionMoves.clear();
+}
 
 std::string Engine::visualize() const {
     std::stringstream ss;
@@ -240,6 +439,13 @@ std::string Engine::visualize() const {
 
 int Engine::get_hashfull(int maxAge) const { return tt.hashfull(maxAge); }
 
+int Engine::get_duplicate_root_work() const {
+    const uint64_t rootNodes = threads.rootNodes;
+    return rootNodes ? int(1000 * threads.duplicateRootNodes / rootNodes) : 0;
+}
+
+int64_t Engine::get_bestmove_latency() { return threads.main_manager()->bestmoveLatency; }
+
 std::vector<std::pair<size_t, size_t>> Engine::get_bound_thread_count_by_numa_node() const {
     auto                                   counts = threads.get_bound_thread_count_by_numa_node();
     const NumaConfig&                      cfg    = numaContext.get_numa_config();
@@ -262,6 +468,14 @@ std::string Engine::numa_config_information_as_string() const {
     return "Available processors: " + cfgStr;
 }
 
+std::string Engine::get_hash_backing() const { return tt.memory_backing(); }
+
+std::string Engine::get_network_backing() const { return network->memory_backing(); }
+
+std::string Engine::large_pages_information_as_string() const {
+    return "Hash backing: " + get_hash_backing() + "\nNetwork backing: " + get_network_backing();
+}
+
 std::string Engine::thread_binding_information_as_string() const {
     auto              boundThreadsByNode = get_bound_thread_count_by_numa_node();
     std::stringstream ss;
@@ -287,6 +501,12 @@ std::string Engine::thread_allocation_information_as_string() const {
     size_t threadsSize = threads.size();
     ss << "Using " << threadsSize << (threadsSize > 1 ? " threads" : " thread");
 
+    // Report the memory saved by sharing the history tables
+    size_t tablesCount = threads.history_tables_count();
+    if (tablesCount < threadsSize)
+        ss << " sharing " << tablesCount << " set(s) of history tables ("
+           << (threadsSize - tablesCount) * sizeof(HistoryTables) / (1024 * 1024) << " MiB saved)";
+
     auto boundThreadsByNodeStr = thread_binding_information_as_string();
     if (boundThreadsByNodeStr.empty())
         return ss.str();
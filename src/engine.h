@@ -28,11 +28,13 @@
 #include <utility>
 #include <vector>
 
+#include "distributed.h"
 #include "nnue/network.h"
 #include "numa.h"
 #include "position.h"
 #include "search.h"
 #include "thread.h"
+#include "trainingdata.h"
 #include "tt.h"
 #include "types.h"
 #include "ucioption.h"
@@ -45,7 +47,9 @@ class Engine {
     using InfoFull  = Search::InfoFull;
     using InfoIter  = Search::InfoIteration;
 
-    Engine(std::optional<std::string> path = std::nullopt);
+    // A fast start defers zeroing the hash and replicating the network on the
+    // NUMA nodes to ensure_ready()
+    Engine(std::optional<std::string> path = std::nullopt, bool fastStart = false);
 
     // Cannot be movable due to components holding backreferences to fields
     Engine(const Engine&)            = delete;
@@ -57,11 +61,21 @@ class Engine {
 
     std::uint64_t perft(const std::string& fen, Depth depth);
 
+    // blocking call to play self-play games and write them as training data
+    void generate(const TrainingData::GenerateSetup& setup);
+    // blocking call to search the positions of a training data file again
+    void rescore(const TrainingData::RescoreSetup& setup);
+
+    // builds an endgame tablebase and the smaller ones it needs
+    void generate_tablebase(const std::string& signature, const std::string& directory);
+
     // non blocking call to start searching
     void go(Search::LimitsType&);
     // non blocking call to stop searching
     void stop();
 
+    // blocking call to complete the startup work deferred by a fast start
+    void ensure_ready();
     // blocking call to wait for search to finish
     void wait_for_search_finished();
     // set a new position, moves are in UCI format
@@ -69,11 +83,14 @@ class Engine {
 
     // modifiers
 
-    void set_numa_config_from_option(const std::string& o);
-    void resize_threads();
-    void set_tt_size(size_t mb);
-    void set_ponderhit(bool);
-    void search_clear();
+    void        set_numa_config_from_option(const std::string& o);
+    void        set_large_pages_from_option(const std::string& o);
+    std::string set_cluster_from_options();
+    void        resize_threads();
+    void        set_tt_size(size_t mb);
+    void        set_mate_table_size(size_t mb);
+    void        set_ponderhit(bool);
+    void        search_clear();
 
     void set_on_update_no_moves(std::function<void(const InfoShort&)>&&);
     void set_on_update_full(std::function<void(const InfoFull&)>&&);
@@ -96,7 +113,16 @@ class Engine {
 
     int get_hashfull(int maxAge = 0) const;
 
+    // Root nodes of the last search spent on a depth already completed by
+    // another thread, per mille
+    int get_duplicate_root_work() const;
+
+    // Time taken by the last search to pick and send the bestmove once it
+    // stopped, in microseconds
+    int64_t get_bestmove_latency();
+
     std::string                            fen() const;
+    std::string                            position_command() const;
     void                                   flip();
     std::string                            visualize() const;
     std::vector<std::pair<size_t, size_t>> get_bound_thread_count_by_numa_node() const;
@@ -104,19 +130,29 @@ class Engine {
     std::string                            numa_config_information_as_string() const;
     std::string                            thread_allocation_information_as_string() const;
     std::string                            thread_binding_information_as_string() const;
+    std::string                            get_hash_backing() const;
+    std::string                            get_network_backing() const;
+    std::string                            large_pages_information_as_string() const;
 
    private:
     const std::string binaryDirectory;
 
+    bool startupDeferred;
+
     NumaReplicationContext numaContext;
 
     Position     pos;
     StateListPtr states;
 
+    // The last 'position' command, used to detect move lists that extend it
+    std::string              positionFen;
+    std::vector<std::string> positionMoves;
+
     OptionsMap                              options;
     ThreadPool                              threads;
     TranspositionTable                      tt;
     LazyNumaReplicated<Eval::NNUE::Network> network;
+    Distributed::Node                       cluster;
 
     Search::SearchManager::UpdateContext  updateContext;
     std::function<void(std::string_view)> onVerifyNetworks;
@@ -26,6 +26,7 @@
 #include <memory>
 #include <sstream>
 
+#include "endgame.h"
 #include "nnue/network.h"
 #include "nnue/nnue_misc.h"
 #include "position.h"
@@ -58,6 +59,11 @@ Value Eval::evaluate(const Eval::NNUE::Network& network,
     // Damp down the evaluation linearly when shuffling
     v -= (v * pos.rule60_count()) / 267;
 
+    // Scale down the evaluation of a side whose material is nearly always drawn
+    const Endgames::Verdict verdict = Endgames::probe(pos);
+    if ((v > 0 && (verdict & Endgames::CANNOT_WIN)) || (v < 0 && (verdict & Endgames::CANNOT_LOSE)))
+        v /= 8;
+
     // Guarantee evaluation does not hit the mate range
     v = std::clamp(v, VALUE_MATED_IN_MAX_PLY + 1, VALUE_MATE_IN_MAX_PLY - 1);
 
@@ -159,6 +159,22 @@ struct CorrHistTypedef<Continuation> {
 template<CorrHistType T>
 using CorrectionHistory = typename Detail::CorrHistTypedef<T>::type;
 
+// The history tables a search thread may share with the other threads of its
+// NUMA node, see the SharedHistory option. Like those of the transposition
+// table, the concurrent updates of the entries are not synchronized.
+struct HistoryTables {
+    void clear();
+
+    ButterflyHistory      mainHistory;
+    CapturePieceToHistory captureHistory;
+    PawnHistory           pawnHistory;
+
+    CorrectionHistory<Pawn>         pawnCorrectionHistory;
+    CorrectionHistory<Minor>        minorPieceCorrectionHistory;
+    CorrectionHistory<NonPawn>      nonPawnCorrectionHistory[COLOR_NB];
+    CorrectionHistory<Continuation> continuationCorrectionHistory;
+};
+
 }  // namespace Stockfish
 
 #endif  // #ifndef HISTORY_H_INCLUDED
@@ -31,12 +31,24 @@ int main(int argc, char* argv[]) {
 
     std::cout << engine_info() << std::endl;
 
+    // Flags are removed from the arguments, the rest is run as a command
+    if (CommandLine::remove_flag(argc, argv, "--startup-profile"))
+        StartupTimer::enable();
+
+    const bool fastStart = CommandLine::remove_flag(argc, argv, "--fast-start");
+
+    StartupTimer total("total"), timer("Bitboards::init");
     Bitboards::init();
+    timer.stop();
+
+    StartupTimer positionTimer("Position::init");
     Position::init();
+    positionTimer.stop();
 
-    UCIEngine uci(argc, argv);
+    UCIEngine uci(argc, argv, fastStart);
 
     Tune::init(uci.engine_options());
+    total.stop();
 
     uci.loop();
 
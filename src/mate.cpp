@@ -0,0 +1,355 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2025 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "mate.h"
+
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <unordered_set>
+
+#include "misc.h"
+#include "movegen.h"
+#include "position.h"
+
+namespace Stockfish::Mate {
+
+namespace {
+
+constexpr uint32_t Infinite = 1u << 30;
+
+// A position is searched by the attacker when an odd number of plies is left
+// to it, as the mate is given by the last ply.
+bool attacker_to_move(int depth) { return depth % 2; }
+
+// Whether the values of a position, from the point of view of its side to
+// move, prove a mate, or prove there is none within the plies left
+bool is_proof(uint32_t phi, uint32_t delta, int depth) {
+    return (attacker_to_move(depth) ? phi : delta) == 0;
+}
+bool is_disproof(uint32_t phi, uint32_t delta, int depth) {
+    return (attacker_to_move(depth) ? delta : phi) == 0;
+}
+
+// Entries with fewer plies left are cheaper to search again, and resolved ones
+// are kept first.
+int priority(const Entry& e) {
+    const bool resolved = is_proof(e.phi, e.delta, e.depth) || is_disproof(e.phi, e.delta, e.depth);
+    return e.depth + 256 * resolved;
+}
+
+}  // namespace
+
+void Solver::resize(size_t mbSize) {
+
+    const size_t clusterCount = std::max(size_t(1), mbSize * 1024 * 1024 / sizeof(Cluster));
+
+    if (table.size() != clusterCount)
+    {
+        table = std::vector<Cluster>(clusterCount);
+        epoch = 0;
+    }
+}
+
+// Empties the table lazily, entries of previous epochs being ignored. It is
+// only filled with zeros when the epoch wraps around.
+void Solver::clear() {
+
+    if (++epoch == 0)
+        std::fill(table.begin(), table.end(), Cluster{});
+}
+
+// Returns the values of the position stored with the given number of plies
+// left. A mate stays proven with more plies, and its absence with less, while
+// other values are only kept for the same number of plies.
+Solver::Values Solver::lookup(Key key, int depth) const {
+
+    const Cluster& cluster = table[mul_hi64(key, table.size())];
+
+    for (const Entry& e : cluster.entry)
+        if (e.key32 == uint32_t(key) && e.epoch == epoch && (e.phi || e.delta))
+        {
+            const bool valid = is_proof(e.phi, e.delta, depth)    ? e.dist <= depth
+                             : is_disproof(e.phi, e.delta, depth) ? e.depth >= depth
+                                                                  : e.depth == depth;
+            if (valid)
+                return {e.phi, e.delta, e.dist};
+            break;
+        }
+
+    return {1, 1, 0};
+}
+
+void Solver::store(Key key, Values v, int depth) {
+
+    Cluster& cluster = table[mul_hi64(key, table.size())];
+    Entry*   replace = &cluster.entry[0];
+
+    // Keep the entry of the position if any, else replace the least valuable one
+    for (Entry& e : cluster.entry)
+    {
+        if (e.key32 == uint32_t(key) || e.epoch != epoch || !(e.phi || e.delta))
+        {
+            replace = &e;
+            break;
+        }
+
+        if (priority(e) < priority(*replace))
+            replace = &e;
+    }
+
+    assert(!is_proof(v.phi, v.delta, depth) || v.dist <= depth);
+
+    replace->key32 = uint32_t(key);
+    replace->phi   = v.phi;
+    replace->delta = v.delta;
+    replace->depth = uint8_t(depth);
+    replace->dist  = uint8_t(std::min(v.dist, 255));
+    replace->epoch = epoch;
+}
+
+// Searches the position until its proof number reaches thPhi or its disproof
+// number reaches thDelta, and returns its values. The proof number of a
+// position is the smallest disproof number of its children, and its disproof
+// number the sum of their proof numbers.
+Solver::Values Solver::mid(Position& pos, uint32_t thPhi, uint32_t thDelta, int depth, int ply) {
+
+    const bool attacker = attacker_to_move(depth);
+    const Key  key      = pos.key();
+
+    if (((nodes->fetch_add(1, std::memory_order_relaxed) + 1) & 1023) == 0 && (*stopCheck)())
+        stopped = true;
+
+    // A repetition or the rule 60 fails the attacker, who needs a real mate. The
+    // outcome depends on the path taken, so it is returned without being stored.
+    Value result;
+    if (ply && pos.rule_judge(result, ply))
+        return attacker ? Values{Infinite, 0, 0, true} : Values{0, Infinite, 0, true};
+
+    // Without plies left, the defender has escaped unless it has no moves
+    if (depth == 0)
+    {
+        const bool escaped = MoveList<LEGAL>(pos).size();
+        const auto v       = escaped ? Values{0, Infinite, 0} : Values{Infinite, 0, 0};
+        store(key, v, depth);
+        return v;
+    }
+
+    // Values depending on the path are kept here instead of in the table
+    struct Child {
+        Move   move;
+        Key    key;
+        Values values;
+    };
+
+    Child  children[MAX_MOVES];
+    size_t count = 0;
+
+    for (const auto& m : MoveList<LEGAL>(pos))
+        if (!attacker || pos.gives_check(m))
+        {
+            StateInfo st;
+            pos.do_move(m, st, nullptr);
+            children[count++] = {m, pos.key(), {}};
+            pos.undo_move(m);
+        }
+
+    while (true)
+    {
+        Values   v{Infinite, 0, 0};
+        Values   bestChild{};
+        uint32_t delta2   = Infinite;
+        size_t   best     = 0;
+        int      winDist  = 255;
+        int      lossDist = 0;
+        bool     ruled    = false;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Values c = children[i].values.pathDependent ? children[i].values
+                                                              : lookup(children[i].key, depth - 1);
+
+            ruled |= c.pathDependent;
+
+            v.delta = std::min(Infinite, v.delta + c.phi);
+
+            if (c.delta < v.phi)
+            {
+                delta2    = v.phi;
+                v.phi     = c.delta;
+                bestChild = c;
+                best      = i;
+            }
+            else if (c.delta < delta2)
+                delta2 = c.delta;
+
+            if (c.delta == 0)
+                winDist = std::min(winDist, c.dist + 1);
+            lossDist = std::max(lossDist, c.dist + 1);
+        }
+
+        // With no moves, or no checks for the attacker, the side to move has lost
+        v.dist = v.phi == 0 ? winDist : v.delta == 0 ? lossDist : 0;
+
+        // A win needs one child, a loss all of them
+        v.pathDependent = v.phi == 0 ? bestChild.pathDependent : v.delta == 0 && ruled;
+
+        if (v.phi >= thPhi || v.delta >= thDelta || stopped)
+        {
+            if (!v.pathDependent)
+                store(key, v, depth);
+            return v;
+        }
+
+        StateInfo st;
+        pos.do_move(children[best].move, st, nullptr);
+        children[best].values =
+          mid(pos, std::min(Infinite, thDelta + bestChild.phi - v.delta),
+              std::min(thPhi, delta2 + 1), depth - 1, ply + 1);
+        pos.undo_move(children[best].move);
+    }
+}
+
+// Follows the proof from the root, the attacker taking the shortest mate and
+// the defender the longest one.
+std::vector<Move> Solver::extract_pv(Position& pos, int depth) {
+
+    std::vector<Move>     pv;
+    std::deque<StateInfo> states;
+
+    for (; depth > 0; --depth)
+    {
+        const bool attacker = attacker_to_move(depth);
+        Move       bestMove = Move::none();
+        int        bestDist = attacker ? 256 : -1;
+
+        for (const auto& m : MoveList<LEGAL>(pos))
+        {
+            if (attacker && !pos.gives_check(m))
+                continue;
+
+            StateInfo st;
+            pos.do_move(m, st, nullptr);
+            const Values c = lookup(pos.key(), depth - 1);
+            pos.undo_move(m);
+
+            if (is_proof(c.phi, c.delta, depth - 1)
+                && (attacker ? c.dist < bestDist : c.dist > bestDist))
+            {
+                bestMove = m;
+                bestDist = c.dist;
+            }
+        }
+
+        if (bestMove == Move::none())
+            break;
+
+        pv.push_back(bestMove);
+        pos.do_move(bestMove, states.emplace_back(), nullptr);
+    }
+
+    for (auto it = pv.rbegin(); it != pv.rend(); ++it)
+        pos.undo_move(*it);
+
+    return pv;
+}
+
+// Counts the positions of the proof tree: one mating line for the attacker,
+// and all the replies of the defender.
+uint64_t Solver::proof_size(Position& pos, int depth, std::unordered_set<Key>& visited) {
+
+    if (depth == 0 || !visited.insert(pos.key()).second)
+        return depth == 0;
+
+    uint64_t   size     = 1;
+    const bool attacker = attacker_to_move(depth);
+    Move       bestMove = Move::none();
+    int        bestDist = 256;
+
+    for (const auto& m : MoveList<LEGAL>(pos))
+    {
+        if (attacker && !pos.gives_check(m))
+            continue;
+
+        StateInfo st;
+        pos.do_move(m, st, nullptr);
+
+        if (!attacker)
+            size += proof_size(pos, depth - 1, visited);
+        else
+        {
+            const Values c = lookup(pos.key(), depth - 1);
+            if (is_proof(c.phi, c.delta, depth - 1) && c.dist < bestDist)
+            {
+                bestMove = m;
+                bestDist = c.dist;
+            }
+        }
+
+        pos.undo_move(m);
+    }
+
+    if (bestMove != Move::none())
+    {
+        StateInfo st;
+        pos.do_move(bestMove, st, nullptr);
+        size += proof_size(pos, depth - 1, visited);
+        pos.undo_move(bestMove);
+    }
+
+    return size;
+}
+
+Result Solver::solve(Position&              pos,
+                     int                    moves,
+                     std::atomic<uint64_t>& nodeCounter,
+                     const StopCheck&       stop,
+                     const OnProof&         onProof) {
+
+    nodes     = &nodeCounter;
+    stopCheck = &stop;
+    stopped   = false;
+
+    Result result{};
+    int    depth = std::min(2 * moves - 1, MAX_PLY - 1);
+
+    while (depth > 0)
+    {
+        const Values v = mid(pos, Infinite, Infinite, depth, 0);
+
+        if (stopped || v.phi != 0)
+            break;
+
+        Result r{extract_pv(pos, depth), 0};
+        if (r.pv.empty())
+            break;
+
+        std::unordered_set<Key> visited;
+        r.proofSize = proof_size(pos, depth, visited);
+
+        onProof(r);
+        result = std::move(r);
+
+        // Look for a shorter mate
+        depth = v.dist - 2;
+    }
+
+    return result;
+}
+
+}  // namespace Stockfish::Mate
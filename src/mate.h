@@ -0,0 +1,105 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2025 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATE_H_INCLUDED
+#define MATE_H_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_set>
+#include <vector>
+
+#include "types.h"
+
+namespace Stockfish {
+
+class Position;
+
+// Proves forced mates with depth-first proof-number search (df-pn). Only the
+// checking moves of the attacker, the side to move at the root, and the replies
+// of the defender are searched. The proof and disproof numbers of the positions
+// are kept in a table of the solver, separate from the transposition table.
+namespace Mate {
+
+struct Entry {
+    uint32_t key32;
+    uint32_t phi;    // Proof number for the side to move
+    uint32_t delta;  // Disproof number for the side to move
+    uint8_t  depth;  // Plies left to the attacker when the entry was stored
+    uint8_t  dist;   // Plies to the end of the game when the side to move is lost or won
+    uint16_t epoch;  // Search the entry was stored in, older ones being empty
+};
+
+static_assert(sizeof(Entry) == 16, "Entry must be 16 bytes");
+
+struct Cluster {
+    Entry entry[4];
+};
+
+static_assert(sizeof(Cluster) == 64, "Cluster must be one cache line");
+
+struct Result {
+    std::vector<Move> pv;         // Empty if no mate was found
+    uint64_t          proofSize;  // Positions of the proof tree
+};
+
+class Solver {
+   public:
+    using StopCheck = std::function<bool()>;
+    using OnProof   = std::function<void(const Result&)>;
+
+    void resize(size_t mbSize);
+    void clear();
+
+    // Looks for a mate in at most the given number of moves, then for shorter
+    // ones until there are none, calling onProof for each mate found. Returns
+    // the shortest mate found.
+    Result solve(Position&              pos,
+                 int                    moves,
+                 std::atomic<uint64_t>& nodeCounter,
+                 const StopCheck&       stop,
+                 const OnProof&         onProof);
+
+   private:
+    struct Values {
+        uint32_t phi, delta;
+        int      dist;
+        bool     pathDependent = false;  // Resolved by a rule outcome of the path taken
+    };
+
+    Values mid(Position& pos, uint32_t thPhi, uint32_t thDelta, int depth, int ply);
+    Values lookup(Key key, int depth) const;
+    void   store(Key key, Values v, int depth);
+
+    std::vector<Move> extract_pv(Position& pos, int depth);
+    uint64_t          proof_size(Position& pos, int depth, std::unordered_set<Key>& visited);
+
+    std::vector<Cluster>   table;
+    uint16_t               epoch     = 0;
+    std::atomic<uint64_t>* nodes     = nullptr;
+    const StopCheck*       stopCheck = nullptr;
+    bool                   stopped   = false;
+};
+
+}  // namespace Mate
+
+}  // namespace Stockfish
+
+#endif  // #ifndef MATE_H_INCLUDED
@@ -18,16 +18,30 @@
 
 #include "memory.h"
 
+#include <atomic>
 #include <cstdlib>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 #if __has_include("features.h")
     #include <features.h>
 #endif
 
 #if defined(__linux__) && !defined(__ANDROID__)
+    #include <cstdio>
+    #include <fstream>
     #include <sys/mman.h>
 #endif
 
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__ANDROID__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define POSIXSHAREDMEMORY
+#endif
+
 #if defined(__APPLE__) || defined(__ANDROID__) || defined(__OpenBSD__) \
   || (defined(__GLIBCXX__) && !defined(_GLIBCXX_HAVE_ALIGNED_ALLOC) && !defined(_WIN32)) \
   || defined(__e2k__)
@@ -66,6 +80,45 @@ using AdjustTokenPrivileges_t =
 
 namespace Stockfish {
 
+namespace {
+
+// Remembers how each block returned by aligned_large_pages_alloc() or
+// shared_memory_map() was obtained, which is needed both to free it and to
+// report which pages back it.
+struct LargePageBlock {
+    size_t      size;
+    size_t      largePageSize;  // Size of the explicitly allocated large pages, 0 if none
+    std::string unlinkName;     // Name of the shared memory to remove on unmap, if created here
+};
+
+std::mutex                                largePageBlocksMutex;
+std::unordered_map<void*, LargePageBlock> largePageBlocks;
+std::atomic<LargePageMode>                largePageMode{LARGE_PAGES_AUTO};
+
+void* register_large_page_block(void* mem, size_t size, size_t largePageSize) {
+    if (mem)
+    {
+        std::lock_guard<std::mutex> lk(largePageBlocksMutex);
+        largePageBlocks[mem] = {size, largePageSize, {}};
+    }
+    return mem;
+}
+
+bool unregister_large_page_block(void* mem, LargePageBlock& block) {
+    std::lock_guard<std::mutex> lk(largePageBlocksMutex);
+    auto                        it = largePageBlocks.find(mem);
+    if (it == largePageBlocks.end())
+        return false;
+
+    block = it->second;
+    largePageBlocks.erase(it);
+    return true;
+}
+
+}  // namespace
+
+void set_large_pages_mode(LargePageMode mode) { largePageMode = mode; }
+
 // Wrappers for systems where the c++17 implementation does not guarantee the
 // availability of aligned_alloc(). Memory allocated with std_aligned_alloc()
 // must be freed with std_aligned_free().
@@ -182,21 +235,53 @@ static void* aligned_large_pages_alloc_windows([[maybe_unused]] size_t allocSize
 void* aligned_large_pages_alloc(size_t allocSize) {
 
     // Try to allocate large pages
-    void* mem = aligned_large_pages_alloc_windows(allocSize);
+    void* mem = largePageMode != LARGE_PAGES_OFF ? aligned_large_pages_alloc_windows(allocSize)
+                                                 : nullptr;
+    if (mem)
+        return register_large_page_block(mem, allocSize, GetLargePageMinimum());
 
     // Fall back to regular, page-aligned, allocation if necessary
-    if (!mem)
-        mem = VirtualAlloc(nullptr, allocSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    mem = VirtualAlloc(nullptr, allocSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
 
-    return mem;
+    return register_large_page_block(mem, allocSize, 0);
 }
 
 #else
 
+    #if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+
+// Allocates from the pool of huge pages reserved by the administrator (see
+// vm.nr_hugepages), fails if not enough pages of the given size are available.
+static void* aligned_large_pages_alloc_hugetlb(size_t allocSize, size_t pageSize) {
+
+    const int pageShift = pageSize == GiB ? 30 : 21;
+    const int flags     = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (pageShift << MAP_HUGE_SHIFT);
+    size_t    size      = ((allocSize + pageSize - 1) / pageSize) * pageSize;
+    void*     mem       = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+
+    return mem != MAP_FAILED ? register_large_page_block(mem, size, pageSize) : nullptr;
+}
+
+    #endif
+
 void* aligned_large_pages_alloc(size_t allocSize) {
 
+    [[maybe_unused]] const LargePageMode mode = largePageMode;
+
+    #if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+    // Explicit huge pages first, in 'auto' mode only if the allocation is big
+    // enough not to waste most of a page.
+    for (size_t pageSize : {GiB, 2 * MiB})
+        if (mode == (pageSize == GiB ? LARGE_PAGES_HUGETLB_1G : LARGE_PAGES_HUGETLB_2M)
+            || (mode == LARGE_PAGES_AUTO && allocSize >= pageSize
+                && (pageSize != GiB || allocSize % GiB == 0)))
+            if (void* mem = aligned_large_pages_alloc_hugetlb(allocSize, pageSize))
+                return mem;
+    #endif
+
     #if defined(__linux__)
-    constexpr size_t alignment = 2 * 1024 * 1024;  // 2MB page size assumed
+    // 2MB page size assumed for transparent huge pages
+    const size_t alignment = mode != LARGE_PAGES_OFF ? 2 * MiB : 4096;
     #else
     constexpr size_t alignment = 4096;  // small page size assumed
     #endif
@@ -204,16 +289,20 @@ void* aligned_large_pages_alloc(size_t allocSize) {
     // Round up to multiples of alignment
     size_t size = ((allocSize + alignment - 1) / alignment) * alignment;
     void*  mem  = std_aligned_alloc(alignment, size);
-    #if defined(MADV_HUGEPAGE)
-    madvise(mem, size, MADV_HUGEPAGE);
+    #if defined(MADV_HUGEPAGE) && defined(MADV_NOHUGEPAGE)
+    if (mem)
+        madvise(mem, size, mode != LARGE_PAGES_OFF ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
     #endif
-    return mem;
+    return register_large_page_block(mem, size, 0);
 }
 
 #endif
 
 bool has_large_pages() {
 
+    if (largePageMode == LARGE_PAGES_OFF)
+        return false;
+
 #if defined(_WIN32)
 
     constexpr size_t page_size = 2 * 1024 * 1024;  // 2MB page size assumed
@@ -251,6 +340,9 @@ bool has_large_pages() {
 
 void aligned_large_pages_free(void* mem) {
 
+    LargePageBlock block;
+    unregister_large_page_block(mem, block);
+
     if (mem && !VirtualFree(mem, 0, MEM_RELEASE))
     {
         DWORD err = GetLastError();
@@ -262,7 +354,195 @@ void aligned_large_pages_free(void* mem) {
 
 #else
 
-void aligned_large_pages_free(void* mem) { std_aligned_free(mem); }
+void aligned_large_pages_free(void* mem) {
+
+    LargePageBlock block;
+    if (!unregister_large_page_block(mem, block) || !block.largePageSize)
+        std_aligned_free(mem);
+    #if defined(__linux__) && !defined(__ANDROID__)
+    else
+        munmap(mem, block.size);
+    #endif
+}
+
+#endif
+
+
+// Describes the pages which actually back a block returned by
+// aligned_large_pages_alloc(). On Linux, the amount of transparent huge pages
+// is read from /proc/self/smaps, as madvise() is only a hint to the kernel.
+std::string large_pages_backing(const void* mem) {
+
+    LargePageBlock block{};
+    {
+        std::lock_guard<std::mutex> lk(largePageBlocksMutex);
+        auto it = largePageBlocks.find(const_cast<void*>(mem));
+        if (it == largePageBlocks.end())
+            return "none";
+        block = it->second;
+    }
+
+    auto to_mib = [](size_t bytes) { return std::to_string((bytes + MiB / 2) / MiB) + " MiB"; };
+
+    if (block.largePageSize)
+        return to_mib(block.size) + " in "
+             + (block.largePageSize >= GiB ? std::to_string(block.largePageSize / GiB) + " GiB"
+                                           : std::to_string(block.largePageSize / MiB) + " MiB")
+             + " large pages";
+
+#if defined(__linux__) && !defined(__ANDROID__)
+
+    // Sum up the mappings overlapping the block. Neighbouring allocations may
+    // be merged into the same mapping, so this is only exact for large blocks.
+    std::ifstream smaps("/proc/self/smaps");
+    std::string   line;
+    uintptr_t     begin = reinterpret_cast<uintptr_t>(mem), end = begin + block.size;
+    bool          overlaps = false, mapped = false;
+    size_t        hugeKiB = 0, rssKiB = 0, kib;
+    unsigned long lo, hi;
+
+    while (std::getline(smaps, line))
+        if (std::sscanf(line.c_str(), "%lx-%lx ", &lo, &hi) == 2)
+            mapped |= overlaps = lo < end && hi > begin;
+        else if (overlaps
+                 && (std::sscanf(line.c_str(), "AnonHugePages: %zu kB", &kib) == 1
+                     || std::sscanf(line.c_str(), "ShmemPmdMapped: %zu kB", &kib) == 1))
+            hugeKiB += kib;
+        else if (overlaps && std::sscanf(line.c_str(), "Rss: %zu kB", &kib) == 1)
+            rssKiB += kib;
+
+    if (rssKiB)
+        return to_mib(block.size) + ", " + to_mib(std::min(hugeKiB * 1024, block.size))
+             + " in transparent huge pages";
+
+    // Nothing resident yet, e.g. after --fast-start, so the backing is unknown
+    if (mapped)
+        return to_mib(block.size) + ", not touched yet";
+
+#endif
+
+    return to_mib(block.size) + " in regular pages";
+}
+
+
+// shared_memory_map() maps a named segment, which stays until the process which
+// created it unmaps it, so that it can be attached by the processes started in
+// the meantime. On Linux the segment is backed by transparent huge pages when
+// shmem_enabled allows it, the explicitly reserved ones not being shareable by
+// name without a hugetlbfs mount.
+
+#if defined(_WIN32)
+
+void* shared_memory_map(const std::string& name, size_t& size, bool& created) {
+
+    const std::string path = "Local\\" + name;
+    HANDLE            hMap =
+      CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, DWORD(uint64_t(size) >> 32),
+                         DWORD(size), path.c_str());
+    if (!hMap)
+        return nullptr;
+
+    created   = GetLastError() != ERROR_ALREADY_EXISTS;
+    void* mem = MapViewOfFile(hMap, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+
+    // The view keeps the segment alive
+    CloseHandle(hMap);
+
+    MEMORY_BASIC_INFORMATION info;
+    if (mem && !created && VirtualQuery(mem, &info, sizeof(info)))
+        size = info.RegionSize;
+
+    return register_large_page_block(mem, size, 0);
+}
+
+void shared_memory_unmap(void* mem) {
+
+    LargePageBlock block;
+    if (unregister_large_page_block(mem, block))
+        UnmapViewOfFile(mem);
+}
+
+#elif defined(POSIXSHAREDMEMORY)
+
+void* shared_memory_map(const std::string& name, size_t& size, bool& created) {
+
+    const std::string path = name[0] == '/' ? name : "/" + name;
+
+    int fd  = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    created = fd != -1;
+
+    if (created)
+    {
+    #if defined(__linux__)
+        // 2MB page size assumed for transparent huge pages
+        const size_t alignment = largePageMode != LARGE_PAGES_OFF ? 2 * MiB : 4096;
+    #else
+        constexpr size_t alignment = 4096;  // small page size assumed
+    #endif
+
+        size = ((size + alignment - 1) / alignment) * alignment;
+
+        if (ftruncate(fd, off_t(size)) != 0)
+        {
+            close(fd);
+            shm_unlink(path.c_str());
+            return nullptr;
+        }
+    }
+    else
+    {
+        struct stat st;
+
+        fd = shm_open(path.c_str(), O_RDWR, 0);
+        if (fd == -1)
+            return nullptr;
+
+        // An empty segment is one still being set up by its creator
+        if (fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            close(fd);
+            return nullptr;
+        }
+
+        size = size_t(st.st_size);
+    }
+
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);  // The mapping keeps the segment open
+
+    if (mem == MAP_FAILED)
+    {
+        if (created)
+            shm_unlink(path.c_str());
+        return nullptr;
+    }
+
+    #if defined(MADV_HUGEPAGE) && defined(MADV_NOHUGEPAGE)
+    madvise(mem, size, largePageMode != LARGE_PAGES_OFF ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+    #endif
+
+    std::lock_guard<std::mutex> lk(largePageBlocksMutex);
+    largePageBlocks[mem] = {size, 0, created ? path : std::string()};
+    return mem;
+}
+
+void shared_memory_unmap(void* mem) {
+
+    LargePageBlock block;
+    if (!unregister_large_page_block(mem, block))
+        return;
+
+    munmap(mem, block.size);
+
+    if (!block.unlinkName.empty())
+        shm_unlink(block.unlinkName.c_str());
+}
+
+#else
+
+void* shared_memory_map(const std::string&, size_t&, bool&) { return nullptr; }
+void  shared_memory_unmap(void*) {}
 
 #endif
+
 }  // namespace Stockfish
@@ -24,6 +24,7 @@
 #include <cstdint>
 #include <memory>
 #include <new>
+#include <string>
 #include <type_traits>
 #include <utility>
 
@@ -31,6 +32,18 @@
 
 namespace Stockfish {
 
+constexpr size_t MiB = 1024 * 1024;
+constexpr size_t GiB = 1024 * MiB;
+
+// Which pages aligned_large_pages_alloc() should use, see the LargePages option
+enum LargePageMode {
+    LARGE_PAGES_AUTO,        // Explicit huge pages if reserved, transparent ones otherwise
+    LARGE_PAGES_THP,         // Transparent huge pages only
+    LARGE_PAGES_HUGETLB_2M,  // Explicit 2MB huge pages, transparent ones as a fallback
+    LARGE_PAGES_HUGETLB_1G,  // Explicit 1GB huge pages, transparent ones as a fallback
+    LARGE_PAGES_OFF
+};
+
 void* std_aligned_alloc(size_t alignment, size_t size);
 void  std_aligned_free(void* ptr);
 
@@ -38,7 +51,16 @@ void  std_aligned_free(void* ptr);
 void* aligned_large_pages_alloc(size_t size);
 void  aligned_large_pages_free(void* mem);
 
-bool has_large_pages();
+bool        has_large_pages();
+void        set_large_pages_mode(LargePageMode mode);
+std::string large_pages_backing(const void* mem);
+
+// Maps the named memory shared between processes, creating it zeroed with the
+// given size if it does not exist. The size is then updated to the one of the
+// segment, which is the size chosen by its creator when it already existed.
+// Returns nullptr on failure or if the platform is not supported.
+void* shared_memory_map(const std::string& name, size_t& size, bool& created);
+void  shared_memory_unmap(void* mem);
 
 // Frees memory which was placed there with placement new.
 // Works for both single objects and arrays of unknown bound.
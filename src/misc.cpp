@@ -18,6 +18,7 @@
 
 #include "misc.h"
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cassert>
@@ -415,6 +416,32 @@ std::ostream& operator<<(std::ostream& os, SyncCout sc) {
 void sync_cout_start() { std::cout << IO_LOCK; }
 void sync_cout_end() { std::cout << IO_UNLOCK; }
 
+
+namespace {
+bool profileStartup = false;
+}
+
+StartupTimer::StartupTimer(const char* name) :
+    phase(name),
+    start(std::chrono::steady_clock::now()),
+    running(profileStartup) {}
+
+void StartupTimer::stop() {
+
+    if (!running)
+        return;
+
+    running = false;
+
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+
+    sync_cout << "info string Startup " << phase << ": " << std::fixed << std::setprecision(3)
+              << us.count() / 1000.0 << " ms" << std::defaultfloat << sync_endl;
+}
+
+void StartupTimer::enable() { profileStartup = true; }
+
 // Trampoline helper to avoid moving Logger to misc.h
 void start_logger(const std::string& fname) { Logger::start(fname); }
 
@@ -500,6 +527,19 @@ std::string CommandLine::get_binary_directory(std::string argv0) {
     return binaryDirectory;
 }
 
+bool CommandLine::remove_flag(int& argc, char** argv, std::string_view flag) {
+
+    for (int i = 1; i < argc; ++i)
+        if (argv[i] == flag)
+        {
+            std::copy(argv + i + 1, argv + argc, argv + i);
+            argv[--argc] = nullptr;
+            return true;
+        }
+
+    return false;
+}
+
 std::string CommandLine::get_working_directory() {
     std::string workingDirectory = "";
     char        buff[40000];
@@ -511,6 +551,7 @@ std::string CommandLine::get_working_directory() {
 }
 
 std::stringstream read_compressed_nnue(const std::string& fpath) {
+    StartupTimer      timer("network file read and zstd decompression");
     std::stringstream ss;
 
     std::ifstream fin(fpath, std::ios::binary);
@@ -84,6 +84,23 @@ inline TimePoint now() {
       .count();
 }
 
+// Prints the time spent from its construction to stop() or its destruction,
+// when the startup phases are profiled with the --startup-profile flag
+class StartupTimer {
+   public:
+    explicit StartupTimer(const char* name);
+    ~StartupTimer() { stop(); }
+
+    void stop();
+
+    static void enable();
+
+   private:
+    const char*                           phase;
+    std::chrono::steady_clock::time_point start;
+    bool                                  running;
+};
+
 inline std::vector<std::string_view> split(std::string_view s, std::string_view delimiter) {
     std::vector<std::string_view> res;
 
@@ -301,6 +318,9 @@ struct CommandLine {
     static std::string get_binary_directory(std::string argv0);
     static std::string get_working_directory();
 
+    // Removes the flag from the arguments, returning whether it was there
+    static bool remove_flag(int& argc, char** argv, std::string_view flag);
+
     int    argc;
     char** argv;
 };
@@ -18,7 +18,14 @@
 
 #include "movegen.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstdint>
+
+#if defined(USE_AVX512ICL)
+    #include <immintrin.h>
+#endif
 
 #include "bitboard.h"
 #include "position.h"
@@ -27,6 +34,63 @@ namespace Stockfish {
 
 namespace {
 
+// Writes the moves from the given square to all the squares of the bitboard,
+// in square order.
+#if defined(USE_AVX512ICL)
+
+static_assert(sizeof(ExtMove) == 8, "The 64-bit lanes must map to ExtMoves");
+
+alignas(64) constexpr auto SquareIndices = [] {
+    std::array<uint8_t, 64> indices{};
+    for (int i = 0; i < 64; ++i)
+        indices[i] = uint8_t(i);
+    return indices;
+}();
+
+// Each half of the bitboard compresses its squares into consecutive bytes,
+// which are widened 8 at a time into moves, with a zero value.
+inline ExtMove* splat_moves(ExtMove* moveList, Square from, Bitboard b) {
+
+    const __m512i fromVec = _mm512_set1_epi64(Move(from, SQ_A0).raw());
+    const __m512i indices = _mm512_load_si512(SquareIndices.data());
+
+    for (int half = 0; half < 128; half += 64)
+    {
+        const uint64_t bits = uint64_t(b >> half);
+        if (!bits)
+            continue;
+
+        const int          count = popcount(bits);
+        alignas(64) uint8_t to[64];
+        _mm512_store_si512(
+          to, _mm512_maskz_compress_epi8(bits, _mm512_add_epi8(indices, _mm512_set1_epi8(half))));
+
+        for (int i = 0; i < count; i += 8)
+        {
+            const int     n     = std::min(count - i, 8);
+            const __m512i moves = _mm512_add_epi64(
+              fromVec, _mm512_maskz_cvtepu8_epi64(
+                         0xFF, _mm_loadl_epi64(reinterpret_cast<const __m128i*>(to + i))));
+            _mm512_mask_storeu_epi64(moveList, (1u << n) - 1, moves);
+            moveList += n;
+        }
+    }
+
+    return moveList;
+}
+
+#else
+
+inline ExtMove* splat_moves(ExtMove* moveList, Square from, Bitboard b) {
+
+    while (b)
+        *moveList++ = Move(from, pop_lsb(b));
+
+    return moveList;
+}
+
+#endif
+
 template<Color Us, PieceType Pt, GenType Type>
 ExtMove* generate_moves(const Position& pos, ExtMove* moveList, Bitboard target) {
 
@@ -56,8 +120,7 @@ ExtMove* generate_moves(const Position& pos, ExtMove* moveList, Bitboard target)
                 b &= target;
         }
 
-        while (b)
-            *moveList++ = Move(from, pop_lsb(b));
+        moveList = splat_moves(moveList, from, b);
     }
 
     return moveList;
@@ -86,10 +149,7 @@ ExtMove* generate_all(const Position& pos, ExtMove* moveList) {
 
     if (Type != EVASIONS)
     {
-        Bitboard b = attacks_bb<KING>(ksq) & target;
-
-        while (b)
-            *moveList++ = Move(ksq, pop_lsb(b));
+        moveList = splat_moves(moveList, ksq, attacks_bb<KING>(ksq) & target);
     }
 
     return moveList;
@@ -126,50 +186,61 @@ ExtMove* generate<EVASIONS>(const Position& pos, ExtMove* moveList) {
 
     assert(bool(pos.checkers()));
 
-    // If there are more than one checker, use slow version
-    if (more_than_one(pos.checkers()))
-        return generate<PSEUDO_LEGAL>(pos, moveList);
+    Color  us  = pos.side_to_move();
+    Square ksq = pos.king_square(us);
 
-    Color     us      = pos.side_to_move();
-    Square    ksq     = pos.king_square(us);
-    Square    checksq = lsb(pos.checkers());
-    PieceType pt      = type_of(pos.piece_on(checksq));
+    // A move other than a king move must resolve every check at once: it blocks
+    // or captures on a square common to all the checkers, or moves away the
+    // hurdle of a cannon to such a square of the other checkers.
+    Bitboard target = ~pos.pieces(us);
+    Bitboard b      = attacks_bb<KING>(ksq) & ~pos.pieces(us);
+    for (Bitboard checkers = pos.checkers(); checkers;)
+    {
+        Square    checksq = pop_lsb(checkers);
+        PieceType pt      = type_of(pos.piece_on(checksq));
+
+        target &= between_bb(ksq, checksq);
+
+        // For all the squares attacked by slider checkers. We will remove them from
+        // the king evasions in order to skip known illegal moves, which avoids any
+        // useless legality checks later on.
+        if (pt == ROOK || pt == CANNON)
+            b &= ~line_bb(checksq, ksq) | pos.pieces(~us);
+    }
 
-    // Generate blocking evasions or captures of the checking piece
-    Bitboard target = (between_bb(ksq, checksq)) & ~pos.pieces(us);
-    moveList        = us == WHITE ? generate_moves<WHITE, EVASIONS>(pos, moveList, target)
-                                  : generate_moves<BLACK, EVASIONS>(pos, moveList, target);
+    // Generate blocking evasions or captures of the checking pieces
+    if (target)
+        moveList = us == WHITE ? generate_moves<WHITE, EVASIONS>(pos, moveList, target)
+                               : generate_moves<BLACK, EVASIONS>(pos, moveList, target);
 
     // Generate evasions for king, capture and non capture moves
-    Bitboard b = attacks_bb<KING>(ksq) & ~pos.pieces(us);
-    // For all the squares attacked by slider checkers. We will remove them from
-    // the king evasions in order to skip known illegal moves, which avoids any
-    // useless legality checks later on.
-    if (pt == ROOK || pt == CANNON)
-        b &= ~line_bb(checksq, ksq) | pos.pieces(~us);
-    while (b)
-        *moveList++ = Move(ksq, pop_lsb(b));
+    moveList = splat_moves(moveList, ksq, b);
 
     // Generate move away hurdle piece evasions for cannon
-    if (pt == CANNON)
+    for (Bitboard cannons = pos.checkers() & pos.pieces(CANNON); cannons;)
     {
-        Bitboard hurdle = between_bb(ksq, checksq) & pos.pieces(us);
-        if (hurdle)
-        {
-            Square hurdleSq = pop_lsb(hurdle);
-            pt              = type_of(pos.piece_on(hurdleSq));
-            if (pt == PAWN)
-                b = pawn_attacks_bb(us, hurdleSq) & ~line_bb(checksq, hurdleSq) & ~pos.pieces(us);
-            else if (pt == CANNON)
-                b = (attacks_bb<ROOK>(hurdleSq, pos.pieces()) & ~line_bb(checksq, hurdleSq)
-                     & ~pos.pieces())
-                  | (attacks_bb<CANNON>(hurdleSq, pos.pieces()) & pos.pieces(~us));
-            else
-                b = attacks_bb(pt, hurdleSq, pos.pieces()) & ~line_bb(checksq, hurdleSq)
-                  & ~pos.pieces(us);
-            while (b)
-                *moveList++ = Move(hurdleSq, pop_lsb(b));
-        }
+        Square   checksq = pop_lsb(cannons);
+        Bitboard hurdle  = between_bb(ksq, checksq) & pos.pieces(us);
+        if (!hurdle)
+            continue;
+
+        // The hurdle must also resolve the checks of the other pieces
+        Bitboard others = ~Bitboard(0);
+        for (Bitboard checkers = pos.checkers() ^ checksq; checkers;)
+            others &= between_bb(ksq, pop_lsb(checkers));
+
+        Square    hurdleSq = lsb(hurdle);
+        PieceType pt       = type_of(pos.piece_on(hurdleSq));
+        if (pt == PAWN)
+            b = pawn_attacks_bb(us, hurdleSq) & ~line_bb(checksq, hurdleSq) & ~pos.pieces(us);
+        else if (pt == CANNON)
+            b = (attacks_bb<ROOK>(hurdleSq, pos.pieces()) & ~line_bb(checksq, hurdleSq)
+                 & ~pos.pieces())
+              | (attacks_bb<CANNON>(hurdleSq, pos.pieces()) & pos.pieces(~us));
+        else
+            b = attacks_bb(pt, hurdleSq, pos.pieces()) & ~line_bb(checksq, hurdleSq)
+              & ~pos.pieces(us);
+        moveList = splat_moves(moveList, hurdleSq, b & others);
     }
 
     return moveList;
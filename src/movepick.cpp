@@ -18,12 +18,28 @@
 
 #include "movepick.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstdlib>
 #include <limits>
 
+#if defined(USE_AVX2)
+    #include <immintrin.h>
+#endif
+
 #include "bitboard.h"
 #include "misc.h"
 #include "position.h"
+#include "tt.h"
+
+#ifdef MOVEPICK_STATS
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+    #endif
+#endif
 
 namespace Stockfish {
 
@@ -70,6 +86,102 @@ void partial_insertion_sort(ExtMove* begin, ExtMove* end, int limit) {
         }
 }
 
+#if defined(USE_AVX2)
+
+// Sorts the moves like partial_insertion_sort(), without its unpredictable
+// branches. The moves up to the limit are first split off in the same way, then
+// each one is written at its rank, counted with SIMD comparisons of keys made of
+// the value and the position of the move, which keeps the sort stable. The
+// values must fit in 24 bits, as those of the quiet moves do.
+void partial_rank_sort(ExtMove* begin, ExtMove* end, int limit) {
+
+    static_assert(MAX_MOVES <= 128 && MAX_MOVES % 8 == 0, "Keys hold the position in 7 bits");
+
+    if (end - begin < 2)
+        return;
+
+    alignas(32) int32_t keys[MAX_MOVES];
+    ExtMove             sorted[MAX_MOVES];
+    int                 n         = 1;
+    ExtMove*            sortedEnd = begin;
+
+    assert(std::abs(begin->value) < (1 << 23));
+    sorted[0] = *begin;
+    keys[0]   = begin->value * 128 + 127;
+
+    for (ExtMove* p = begin + 1; p < end; ++p)
+    {
+        assert(std::abs(p->value) < (1 << 23));
+        const bool    take = p->value >= limit;
+        const ExtMove next = sortedEnd[1];
+
+        sorted[n] = *p;
+        keys[n]   = p->value * 128 + 127 - n;
+        n += take;
+        if (take)
+            *p = next;
+        sortedEnd += take;
+    }
+
+    std::fill(keys + n, keys + ((n + 7) & ~7), std::numeric_limits<int32_t>::min());
+
+    for (int i = 0; i < n; ++i)
+    {
+        const __m256i key  = _mm256_set1_epi32(keys[i]);
+        int           rank = 0;
+
+        for (int j = 0; j < n; j += 8)
+        {
+            const __m256i greater = _mm256_cmpgt_epi32(
+              _mm256_load_si256(reinterpret_cast<const __m256i*>(keys + j)), key);
+            rank += popcount(unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(greater))));
+        }
+
+        begin[rank] = sorted[i];
+    }
+}
+
+// Gathers the 16-bit entries of a history table at 8 indices, for the lanes of
+// the mask. Each gather reads 4 bytes, which stays inside the tables, as their
+// last entry is never addressed by a move.
+template<typename Entry>
+__m256i gather_history(const Entry* table, __m256i indices, __m256i mask) {
+
+    static_assert(sizeof(Entry) == 2, "History entries must be 16-bit");
+
+    const __m256i v = _mm256_mask_i32gather_epi32(
+      _mm256_setzero_si256(), reinterpret_cast<const int*>(table), indices, mask, 2);
+    return _mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16);
+}
+
+#else
+
+void partial_rank_sort(ExtMove* begin, ExtMove* end, int limit) {
+    partial_insertion_sort(begin, end, limit);
+}
+
+#endif
+
+// With MOVEPICK_STATS, records with dbg_mean_of() the time stamp counter cycles
+// spent scoring (slot 0) and sorting (slot 1) the quiet moves, and their number
+// (slot 2).
+#ifdef MOVEPICK_STATS
+
+uint64_t stats_clock() { return __rdtsc(); }
+
+void quiet_stats(uint64_t start, uint64_t scored, std::ptrdiff_t count) {
+    dbg_mean_of(int64_t(scored - start), 0);
+    dbg_mean_of(int64_t(__rdtsc() - scored), 1);
+    dbg_mean_of(count, 2);
+}
+
+#else
+
+uint64_t stats_clock() { return 0; }
+void     quiet_stats(uint64_t, uint64_t, std::ptrdiff_t) {}
+
+#endif
+
 }  // namespace
 
 
@@ -142,6 +254,12 @@ void MovePicker::score() {
                          | (pos.pieces(us, ADVISOR, BISHOP) & threatenedByPawn);
     }
 
+#if defined(USE_AVX2)
+    alignas(32) int histories[MAX_MOVES];
+    if constexpr (Type == QUIETS)
+        score_histories(histories);
+#endif
+
     for (auto& m : *this)
     {
         if constexpr (Type == CAPTURES)
@@ -157,6 +275,9 @@ void MovePicker::score() {
             Square    to   = m.to_sq();
 
             // histories
+#if defined(USE_AVX2)
+            m.value = histories[&m - cur];
+#else
             m.value = 2 * (*mainHistory)[pos.side_to_move()][m.from_to()];
             m.value += 2 * (*pawnHistory)[pawn_structure_index(pos)][pc][to];
             m.value += (*continuationHistory[0])[pc][to];
@@ -165,6 +286,7 @@ void MovePicker::score() {
             m.value += (*continuationHistory[3])[pc][to];
             m.value += (*continuationHistory[4])[pc][to] / 3;
             m.value += (*continuationHistory[5])[pc][to];
+#endif
 
             // bonus for checks
             m.value += bool((pt == CANNON ? pos.check_squares(pt)
@@ -202,6 +324,58 @@ void MovePicker::score() {
     }
 }
 
+#if defined(USE_AVX2)
+
+// Sums the histories of the quiet moves into the given array, 8 moves at a
+// time. The indices of the moves in the tables are computed first, then each
+// table is read with gathers.
+void MovePicker::score_histories(int* histories) const {
+
+    alignas(32) int32_t fromTo[MAX_MOVES], pieceTo[MAX_MOVES];
+
+    const int n      = int(endMoves - cur);
+    const int padded = (n + 7) & ~7;
+
+    for (int i = 0; i < n; ++i)
+    {
+        fromTo[i]  = cur[i].from_to();
+        pieceTo[i] = pos.moved_piece(cur[i]) * SQUARE_NB + cur[i].to_sq();
+    }
+    std::fill(fromTo + n, fromTo + padded, 0);
+    std::fill(pieceTo + n, pieceTo + padded, 0);
+
+    const auto* main = &(*mainHistory)[pos.side_to_move()][0];
+    const auto* pawn = &(*pawnHistory)[pawn_structure_index(pos)][0][0];
+    const auto* cont = continuationHistory;
+
+    // Dividing by 3 with the high half of a 16-bit product, truncating as C++
+    const __m256i third = _mm256_set1_epi32(21846 << 16);
+
+    for (int i = 0; i < n; i += 8)
+    {
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i mask  = _mm256_cmpgt_epi32(_mm256_set1_epi32(n - i), lanes);
+        const __m256i ft    = _mm256_load_si256(reinterpret_cast<const __m256i*>(fromTo + i));
+        const __m256i pt    = _mm256_load_si256(reinterpret_cast<const __m256i*>(pieceTo + i));
+        const __m256i c4    = _mm256_slli_epi32(gather_history(&(*cont[4])[0][0], pt, mask), 16);
+
+        __m256i sum = _mm256_add_epi32(gather_history(main, ft, mask),  //
+                                       gather_history(pawn, pt, mask));
+        sum         = _mm256_add_epi32(sum, sum);
+        sum         = _mm256_add_epi32(sum, gather_history(&(*cont[0])[0][0], pt, mask));
+        sum         = _mm256_add_epi32(sum, gather_history(&(*cont[1])[0][0], pt, mask));
+        sum         = _mm256_add_epi32(sum, gather_history(&(*cont[2])[0][0], pt, mask));
+        sum         = _mm256_add_epi32(sum, gather_history(&(*cont[3])[0][0], pt, mask));
+        sum         = _mm256_add_epi32(sum, gather_history(&(*cont[5])[0][0], pt, mask));
+        sum         = _mm256_add_epi32(sum, _mm256_srai_epi32(_mm256_mulhi_epi16(c4, third), 16));
+        sum         = _mm256_sub_epi32(sum, _mm256_srai_epi32(c4, 31));
+
+        _mm256_store_si256(reinterpret_cast<__m256i*>(histories + i), sum);
+    }
+}
+
+#endif
+
 // Returns the next move satisfying a predicate function.
 // This never returns the TT move, as it was emitted before.
 template<typename Pred>
@@ -209,7 +383,14 @@ Move MovePicker::select(Pred filter) {
 
     for (; cur < endMoves; ++cur)
         if (*cur != ttMove && filter())
+        {
+            // Prefetch the entries of the moves likely to be searched next,
+            // ahead of the one done when the move is made.
+            for (ExtMove* m = cur + 1; m < std::min(cur + 1 + prefetchCount, endMoves); ++m)
+                prefetch(tt->first_entry(pos.key_after(*m)));
+
             return *cur++;
+        }
 
     return Move::none();
 }
@@ -260,8 +441,11 @@ top:
             cur      = endBadCaptures;
             endMoves = beginBadQuiets = endBadQuiets = generate<QUIETS>(pos, cur);
 
+            const uint64_t start = stats_clock();
             score<QUIETS>();
-            partial_insertion_sort(cur, endMoves, quiet_threshold(depth));
+            const uint64_t scored = stats_clock();
+            partial_rank_sort(cur, endMoves, quiet_threshold(depth));
+            quiet_stats(start, scored, endMoves - cur);
         }
 
         ++stage;
@@ -324,4 +508,11 @@ top:
 
 void MovePicker::skip_quiet_moves() { skipQuiets = true; }
 
+// Makes next_move() prefetch the transposition table entries of the given
+// number of moves following the one it returns, in the order they are sorted.
+void MovePicker::prefetch_ahead(const TranspositionTable* table, int count) {
+    tt            = table;
+    prefetchCount = count;
+}
+
 }  // namespace Stockfish
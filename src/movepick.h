@@ -26,6 +26,7 @@
 namespace Stockfish {
 
 class Position;
+class TranspositionTable;
 
 // The MovePicker class is used to pick one pseudo-legal move at a time from the
 // current position. The most important method is next_move(), which emits one
@@ -50,12 +51,16 @@ class MovePicker {
     MovePicker(const Position&, Move, int, const CapturePieceToHistory*);
     Move next_move();
     void skip_quiet_moves();
+    void prefetch_ahead(const TranspositionTable* table, int count);
 
    private:
     template<typename Pred>
     Move select(Pred);
     template<GenType>
     void     score();
+#if defined(USE_AVX2)
+    void     score_histories(int* histories) const;
+#endif
     ExtMove* begin() { return cur; }
     ExtMove* end() { return endMoves; }
 
@@ -65,13 +70,15 @@ class MovePicker {
     const CapturePieceToHistory* captureHistory;
     const PieceToHistory**       continuationHistory;
     const PawnHistory*           pawnHistory;
+    const TranspositionTable*    tt = nullptr;
     Move                         ttMove;
     ExtMove *                    cur, *endMoves, *endBadCaptures, *beginBadQuiets, *endBadQuiets;
     int                          stage;
     int                          threshold;
     Depth                        depth;
     int                          ply;
-    bool                         skipQuiets = false;
+    int                          prefetchCount = 0;
+    bool                         skipQuiets    = false;
     ExtMove                      moves[MAX_MOVES];
 };
 
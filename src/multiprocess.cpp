@@ -0,0 +1,236 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2025 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "multiprocess.h"
+
+#include <csignal>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <spawn.h>
+    #include <sys/types.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+extern char** environ;
+    #define POSIXSPAWN
+#endif
+
+namespace Stockfish::MultiProcess {
+
+#if defined(POSIXSPAWN)
+
+// An engine process, talked to through pipes on its standard input and output
+class Process {
+   public:
+    explicit Process(const std::string& binary) {
+        int in[2], out[2];
+
+        // Writing to a process that died must fail rather than kill this one
+        std::signal(SIGPIPE, SIG_IGN);
+
+        if (pipe(in) != 0)
+            return;
+
+        if (pipe(out) != 0)
+        {
+            close(in[0]);
+            close(in[1]);
+            return;
+        }
+
+        // Keep the pipes of a process from leaking into the ones started later
+        for (int fd : {in[0], in[1], out[0], out[1]})
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, in[0], STDIN_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+
+        char* argv[] = {const_cast<char*>(binary.c_str()), nullptr};
+        bool  spawned =
+          posix_spawnp(&pid, binary.c_str(), &actions, nullptr, argv, environ) == 0;
+
+        posix_spawn_file_actions_destroy(&actions);
+        close(in[0]);
+        close(out[1]);
+
+        if (!spawned)
+        {
+            pid = -1;
+            close(in[1]);
+            close(out[0]);
+            return;
+        }
+
+        to   = fdopen(in[1], "w");
+        from = fdopen(out[0], "r");
+    }
+
+    // The end of its input makes the engine quit
+    ~Process() {
+        if (to)
+            std::fclose(to);
+        if (pid > 0)
+            waitpid(pid, nullptr, 0);
+        if (from)
+            std::fclose(from);
+    }
+
+    bool running() const { return to && from; }
+
+    // A failed write means the process died, which is then no longer running
+    void send(const std::string& command) {
+        if (!to)
+            return;
+
+        if (std::fputs((command + "\n").c_str(), to) == EOF || std::fflush(to) == EOF)
+        {
+            std::fclose(to);
+            to = nullptr;
+        }
+    }
+
+    bool read_line(std::string& line) {
+        char buf[4096];
+
+        line.clear();
+        while (std::fgets(buf, sizeof(buf), from))
+        {
+            line += buf;
+            if (line.back() == '\n')
+            {
+                line.pop_back();
+                return true;
+            }
+        }
+        return !line.empty();
+    }
+
+   private:
+    pid_t pid  = -1;
+    FILE* to   = nullptr;
+    FILE* from = nullptr;
+};
+
+#else
+
+// Starting the processes is only implemented with posix_spawn()
+class Process {
+   public:
+    explicit Process(const std::string&) {}
+
+    bool running() const { return false; }
+    void send(const std::string&) {}
+    bool read_line(std::string&) { return false; }
+};
+
+#endif
+
+namespace {
+
+// Reads the output of the process up to its best move
+Answer wait_for_bestmove(Process& process) {
+
+    Answer      answer;
+    std::string line, token;
+
+    while (process.read_line(line))
+    {
+        std::istringstream is(line);
+        is >> token;
+
+        if (token == "bestmove")
+        {
+            is >> answer.bestmove >> token >> answer.ponder;
+            break;
+        }
+
+        if (token == "info" && is >> token && token == "depth" && line.find(" pv ") != line.npos)
+        {
+            is >> answer.depth;
+            answer.info = line;
+        }
+    }
+
+    return answer;
+}
+
+}  // namespace
+
+std::string private_shared_hash_name() {
+#if defined(POSIXSPAWN)
+    return "pikafish-" + std::to_string(getpid());
+#else
+    return "pikafish";
+#endif
+}
+
+Workers::Workers(const std::string&              binary,
+                 size_t                          count,
+                 const std::vector<std::string>& commands) {
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        processes.push_back(std::make_unique<Process>(binary));
+
+        if (processes[i]->running())
+            for (const auto& command : commands)
+                processes[i]->send(command);
+    }
+}
+
+Workers::~Workers() = default;
+
+void Workers::stop() {
+
+    std::lock_guard<std::mutex> lk(mutex);
+
+    for (auto& process : processes)
+        if (process->running())
+            process->send("stop");
+}
+
+std::vector<Answer> Workers::wait() {
+
+    std::vector<Answer>      answers(processes.size());
+    std::vector<std::thread> readers;
+
+    // Read all the outputs at once, a full pipe would block its process
+    {
+        std::lock_guard<std::mutex> lk(mutex);
+
+        for (size_t i = 0; i < processes.size(); ++i)
+            if (processes[i]->running())
+                readers.emplace_back([&, i] { answers[i] = wait_for_bestmove(*processes[i]); });
+    }
+
+    for (auto& reader : readers)
+        reader.join();
+
+    std::lock_guard<std::mutex> lk(mutex);
+    processes.clear();
+
+    return answers;
+}
+
+}  // namespace Stockfish::MultiProcess
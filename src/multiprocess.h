@@ -0,0 +1,74 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2025 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MULTIPROCESS_H_INCLUDED
+#define MULTIPROCESS_H_INCLUDED
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Stockfish {
+
+// Runs searches in several engine processes, which cooperate through a
+// transposition table in shared memory (see the SharedHash option) like the
+// threads of one process do. A crash of one of them leaves the others running.
+namespace MultiProcess {
+
+// What a process answered to a go command
+struct Answer {
+    std::string bestmove;  // Empty if the process failed
+    std::string ponder;
+    std::string info;  // Last info line with a pv
+    int         depth = 0;
+};
+
+// A shared hash name private to this process and the ones it starts
+std::string private_shared_hash_name();
+
+class Process;
+
+// Engine processes searching together, while the process starting them goes on
+// with its own input
+class Workers {
+   public:
+    // Starts the given number of engine processes from the binary and sends each
+    // of them the commands, the last one being a go command.
+    Workers(const std::string& binary, size_t count, const std::vector<std::string>& commands);
+    ~Workers();
+
+    // Makes the processes send their best moves as soon as possible. Can be
+    // called from any thread.
+    void stop();
+
+    // Returns the answers of the processes once they have all sent a best move.
+    // The processes quit afterwards.
+    std::vector<Answer> wait();
+
+   private:
+    std::mutex                            mutex;  // Guards the processes against stop()
+    std::vector<std::unique_ptr<Process>> processes;
+};
+
+}  // namespace MultiProcess
+
+}  // namespace Stockfish
+
+#endif  // #ifndef MULTIPROCESS_H_INCLUDED
@@ -235,6 +235,12 @@ NnueEvalTrace Network::trace_evaluate(const Position& pos, AccumulatorCaches::Ca
 }
 
 
+// Describes which pages back the feature transformer, the largest part of the network
+std::string Network::memory_backing() const {
+    return large_pages_backing(featureTransformer.get());
+}
+
+
 void Network::load_user_net(const std::string& dir, const std::string& evalfilePath) {
     std::stringstream sstream     = read_compressed_nnue(dir + evalfilePath);
     auto              description = load(sstream);
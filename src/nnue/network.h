@@ -59,6 +59,8 @@ class Network {
     void verify(std::string evalfilePath, const std::function<void(std::string_view)>&) const;
     NnueEvalTrace trace_evaluate(const Position& pos, AccumulatorCaches::Cache* cache) const;
 
+    std::string memory_backing() const;
+
    private:
     void load_user_net(const std::string&, const std::string&);
 
@@ -145,7 +145,7 @@ Position& Position::set(const string& fenStr, StateInfo* si) {
         {
             put_piece(Piece(idx), sq);
             if (type_of(Piece(idx)) == KING)
-                kingSquare[color_of(Piece(idx))] = sq;
+                board().kingSquare[color_of(Piece(idx))] = sq;
             ++sq;
         }
     }
@@ -176,6 +176,92 @@ Position& Position::set(const string& fenStr, StateInfo* si) {
 }
 
 
+// Initializes the position object with the given packed position, see pack().
+// This is equivalent to set() with the FEN of the position, without any parsing.
+// The packed position must pass is_ok(), as one read from a file may not.
+Position& Position::set_packed(const PackedPosition& pp, StateInfo* si) {
+
+    assert(is_ok(pp));
+
+    Bitboard occupied = 0;
+
+    std::memset(this, 0, sizeof(Position));
+    std::memset(si, 0, sizeof(StateInfo));
+    st = si;
+
+    for (int i = sizeof(pp.occupied) - 1; i >= 0; --i)
+        occupied = (occupied << 8) | pp.occupied[i];
+
+    for (int n = 0; occupied; ++n)
+    {
+        Square s  = pop_lsb(occupied);
+        Piece  pc = Piece((pp.pieces[n / 2] >> (4 * (n % 2))) & 0xF);
+
+        put_piece(pc, s);
+        if (type_of(pc) == KING)
+            board().kingSquare[color_of(pc)] = s;
+    }
+
+    sideToMove = Color(pp.sideToMove);
+    st->rule60 = pp.rule60;
+    gamePly    = pp.gamePly;
+
+    set_state();
+
+    assert(pos_is_ok());
+
+    return *this;
+}
+
+
+bool is_ok(const PackedPosition& pp) {
+
+    // The last byte of the occupancy has bits past the last square
+    if (pp.occupied[SQUARE_NB / 8] >> (SQUARE_NB % 8))
+        return false;
+
+    int n = 0, kings[COLOR_NB] = {};
+
+    for (uint8_t byte : pp.occupied)
+        for (; byte; byte &= byte - 1, ++n)
+        {
+            if (n == 32)
+                return false;
+
+            Piece pc = Piece((pp.pieces[n / 2] >> (4 * (n % 2))) & 0xF);
+
+            if (type_of(pc) == NO_PIECE_TYPE)
+                return false;
+
+            kings[color_of(pc)] += type_of(pc) == KING;
+        }
+
+    return pp.sideToMove <= BLACK && kings[WHITE] == 1 && kings[BLACK] == 1;
+}
+
+
+// Returns the packed representation of the position. Counters too large for
+// their fields, which only occur in artificial positions, are saturated.
+PackedPosition Position::pack() const {
+
+    PackedPosition pp{};
+    int            n = 0;
+
+    for (Bitboard b = pieces(); b; ++n)
+    {
+        Square s = pop_lsb(b);
+        pp.occupied[s / 8] |= 1 << (s % 8);
+        pp.pieces[n / 2] |= piece_on(s) << (4 * (n % 2));
+    }
+
+    pp.sideToMove = uint8_t(sideToMove);
+    pp.rule60     = uint8_t(std::min(st->rule60, 255));
+    pp.gamePly    = uint16_t(std::min(gamePly, 65535));
+
+    return pp;
+}
+
+
 // Sets king attacks to detect if a move gives check
 void Position::set_check_info() const {
 
@@ -206,6 +292,65 @@ void Position::set_check_info() const {
 }
 
 
+#if defined(ATTACK_MAPS)
+
+// Computes the squares attacked by each piece type of both sides, which are
+// then updated incrementally by do_move().
+void Position::set_attack_maps() const {
+
+    for (Color c : {WHITE, BLACK})
+    {
+        st->attacks[c][ALL_PIECES] = 0;
+        st->attacks[c][ROOK]       = compute_attacks<ROOK>(c);
+        st->attacks[c][ADVISOR]    = compute_attacks<ADVISOR>(c);
+        st->attacks[c][CANNON]     = compute_attacks<CANNON>(c);
+        st->attacks[c][PAWN]       = compute_attacks<PAWN>(c);
+        st->attacks[c][KNIGHT]     = compute_attacks<KNIGHT>(c);
+        st->attacks[c][BISHOP]     = compute_attacks<BISHOP>(c);
+        st->attacks[c][KING]       = compute_attacks<KING>(c);
+    }
+}
+
+// Recomputes, after a piece has moved, the attack maps it may have changed:
+// those of the moved and captured pieces, of the rooks and cannons on the lines
+// of the from and to squares, and of the knights and bishops whose leg or eye is
+// one of these squares. Advisors, pawns and kings are never blocked.
+void Position::update_attack_maps(Piece pc, Square from, Square to, Piece captured) {
+
+    const Bitboard squares = square_bb(from) | to;
+    const Bitboard lines   = PseudoAttacks[ROOK][from] | PseudoAttacks[ROOK][to];
+
+    const Bitboard legs =
+      shift<NORTH>(squares) | shift<SOUTH>(squares) | shift<EAST>(squares) | shift<WEST>(squares);
+    const Bitboard eyes = shift<NORTH_EAST>(squares) | shift<NORTH_WEST>(squares)
+                        | shift<SOUTH_EAST>(squares) | shift<SOUTH_WEST>(squares);
+
+    for (Color c : {WHITE, BLACK})
+    {
+        const auto changed = [&](PieceType pt, Bitboard blockers) {
+            return pc == make_piece(c, pt) || captured == make_piece(c, pt)
+                || (pieces(c, pt) & blockers);
+        };
+
+        if (changed(ROOK, lines))
+            st->attacks[c][ROOK] = compute_attacks<ROOK>(c);
+        if (changed(CANNON, lines))
+            st->attacks[c][CANNON] = compute_attacks<CANNON>(c);
+        if (changed(KNIGHT, legs))
+            st->attacks[c][KNIGHT] = compute_attacks<KNIGHT>(c);
+        if (changed(BISHOP, eyes))
+            st->attacks[c][BISHOP] = compute_attacks<BISHOP>(c);
+        if (changed(ADVISOR, 0))
+            st->attacks[c][ADVISOR] = compute_attacks<ADVISOR>(c);
+        if (changed(PAWN, 0))
+            st->attacks[c][PAWN] = compute_attacks<PAWN>(c);
+        if (changed(KING, 0))
+            st->attacks[c][KING] = compute_attacks<KING>(c);
+    }
+}
+
+#endif
+
 // Computes the hash keys of the position, and other
 // data that once computed is updated incrementally as moves are made.
 // The function is only used when a new position is set up
@@ -221,6 +366,10 @@ void Position::set_state() const {
 
     set_check_info();
 
+#if defined(ATTACK_MAPS)
+    set_attack_maps();
+#endif
+
     for (Bitboard b = pieces(); b;)
     {
         Square    s  = pop_lsb(b);
@@ -435,11 +584,34 @@ bool Position::gives_check(Move m) const {
 }
 
 
+// Computes the key of the position after the given pseudo-legal move without
+// doing it, e.g. to prefetch its transposition table entry. It assumes that the
+// rule 60 counter is incremented, which is not the case of some repeated checks.
+Key Position::key_after(Move m) const {
+
+    Square from     = m.from_sq();
+    Square to       = m.to_sq();
+    Piece  pc       = piece_on(from);
+    Piece  captured = piece_on(to);
+    Key    k        = st->key ^ Zobrist::side ^ Zobrist::psq[pc][from] ^ Zobrist::psq[pc][to];
+    int    rule60   = st->rule60 + 1;
+
+    if (captured)
+    {
+        k ^= Zobrist::psq[captured][to];
+        rule60 = 0;
+    }
+
+    return (rule60 < 14 ? k : k ^ make_key((rule60 - 14) / 8)) ^ (filter[k] ? make_key(14) : 0);
+}
+
+
 // Makes a move, and saves all information necessary
 // to a StateInfo object. The move is assumed to be legal. Pseudo-legal
 // moves should be filtered out before this function is called.
 // If a pointer to the TT table is passed, the entry for the new position
-// will be prefetched
+// will be prefetched. The side to move is read at run time: templating this
+// and search() on it measured no faster.
 void Position::do_move(Move                      m,
                        StateInfo&                newSt,
                        bool                      givesCheck,
@@ -569,6 +741,10 @@ void Position::do_move(Move                      m,
     if (tt)
         prefetch(tt->first_entry(key()));
 
+#if defined(ATTACK_MAPS)
+    update_attack_maps(pc, from, to, captured);
+#endif
+
     // Set capture piece
     st->capturedPiece = captured;
 
@@ -587,18 +763,20 @@ void Position::do_move(Move                      m,
 
 // Unmakes a move. When it returns, the position should
 // be restored to exactly the same state as before the move was made.
-void Position::undo_move(Move m) {
+void Position::undo_move([[maybe_unused]] Move m) {
 
     assert(m.is_ok());
 
     sideToMove = ~sideToMove;
 
+    assert(empty(m.from_sq()));
+    assert(type_of(st->capturedPiece) != KING);
+
+    // With copy-make the previous state still holds the board before the move
+#if !defined(COPY_MAKE)
     Square from = m.from_sq();
     Square to   = m.to_sq();
 
-    assert(empty(from));
-    assert(type_of(st->capturedPiece) != KING);
-
     move_piece(to, from);  // Put the piece back at the source square
 
     if (st->capturedPiece)
@@ -607,6 +785,7 @@ void Position::undo_move(Move m) {
 
         put_piece(st->capturedPiece, capsq);  // Restore the captured piece
     }
+#endif
 
     // Finally point our state pointer back to the previous state
     st = st->previous;
@@ -936,6 +1115,24 @@ uint16_t Position::chased(Color c) {
 }
 
 
+// Takes back the last move for chase detection. With copy-make the previous
+// state already holds the board, so that only the ids are moved back.
+void Position::rollback_move() {
+
+#if defined(COPY_MAKE)
+    Square from = st->move.from_sq();
+    Square to   = st->move.to_sq();
+
+    sideToMove    = ~sideToMove;
+    idBoard[from] = idBoard[to];
+    idBoard[to]   = 0;
+#else
+    light_undo_move(st->move, st->capturedPiece);
+#endif
+    st = st->previous;
+}
+
+
 // Detects chases from state st - d to state st
 Value Position::detect_chases(int d, int ply) {
 
@@ -943,8 +1140,8 @@ Value Position::detect_chases(int d, int ply) {
     int whiteId = 0;
     int blackId = 0;
     for (Square s = SQ_A0; s <= SQ_I9; ++s)
-        if (board[s] != NO_PIECE)
-            idBoard[s] = color_of(board[s]) == WHITE ? whiteId++ : blackId++;
+        if (piece_on(s) != NO_PIECE)
+            idBoard[s] = color_of(piece_on(s)) == WHITE ? whiteId++ : blackId++;
 
     Color us = sideToMove, them = ~us;
 
@@ -958,14 +1155,12 @@ Value Position::detect_chases(int d, int ply) {
         {
             if (!chase[sideToMove])
                 break;
-            light_undo_move(st->move, st->capturedPiece);
-            st = st->previous;
+            rollback_move();
         }
         else
         {
             uint16_t after = chased(~sideToMove);
-            light_undo_move(st->move, st->capturedPiece);
-            st = st->previous;
+            rollback_move();
             // Take the exact diff to detect the chase
             chase[sideToMove] &= after & ~chased(sideToMove);
         }
@@ -1166,15 +1361,28 @@ bool Position::pos_is_ok() const {
         || piece_on(king_square(BLACK)) != B_KING)
         assert(0 && "pos_is_ok: Default");
 
+#if defined(ATTACK_MAPS)
+    // Checked even in the quick mode, as nothing else would catch a stale map
+    for (Color c : {WHITE, BLACK})
+        if (st->attacks[c][ROOK] != compute_attacks<ROOK>(c)
+            || st->attacks[c][ADVISOR] != compute_attacks<ADVISOR>(c)
+            || st->attacks[c][CANNON] != compute_attacks<CANNON>(c)
+            || st->attacks[c][PAWN] != compute_attacks<PAWN>(c)
+            || st->attacks[c][KNIGHT] != compute_attacks<KNIGHT>(c)
+            || st->attacks[c][BISHOP] != compute_attacks<BISHOP>(c)
+            || st->attacks[c][KING] != compute_attacks<KING>(c))
+            assert(0 && "pos_is_ok: Attack maps");
+#endif
+
     if (Fast)
         return true;
 
-    if (pieceCount[W_KING] != 1 || pieceCount[B_KING] != 1
+    if (count<KING>(WHITE) != 1 || count<KING>(BLACK) != 1
         || checkers_to(sideToMove, king_square(~sideToMove)))
         assert(0 && "pos_is_ok: Kings");
 
     if ((pieces(WHITE, PAWN) & ~PawnBB[WHITE]) || (pieces(BLACK, PAWN) & ~PawnBB[BLACK])
-        || pieceCount[W_PAWN] > 5 || pieceCount[B_PAWN] > 5)
+        || count<PAWN>(WHITE) > 5 || count<PAWN>(BLACK) > 5)
         assert(0 && "pos_is_ok: Pawns");
 
     if ((pieces(WHITE) & pieces(BLACK)) || (pieces(WHITE) | pieces(BLACK)) != pieces()
@@ -1187,8 +1395,9 @@ bool Position::pos_is_ok() const {
                 assert(0 && "pos_is_ok: Bitboards");
 
     for (Piece pc : Pieces)
-        if (pieceCount[pc] != popcount(pieces(color_of(pc), type_of(pc)))
-            || pieceCount[pc] != std::count(board, board + SQUARE_NB, pc))
+        if (board().pieceCount[pc] != popcount(pieces(color_of(pc), type_of(pc)))
+            || board().pieceCount[pc]
+                 != std::count(board().squares, board().squares + SQUARE_NB, pc))
             assert(0 && "pos_is_ok: Pieces");
 
     return true;
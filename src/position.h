@@ -37,6 +37,27 @@ namespace Stockfish {
 
 class TranspositionTable;
 
+// Board holds the placement of the pieces. With -DCOPY_MAKE it is kept in the
+// StateInfo of each move, so that undoing a move just restores the previous
+// StateInfo, and the counts and the mailbox take a byte each to keep the copy
+// within a few cache lines.
+struct Board {
+    Bitboard byTypeBB[PIECE_TYPE_NB];
+    Bitboard byColorBB[COLOR_NB];
+    Square   kingSquare[COLOR_NB];
+#if defined(COPY_MAKE)
+    uint8_t pieceCount[PIECE_NB];
+    uint8_t squares[SQUARE_NB];
+#else
+    int   pieceCount[PIECE_NB];
+    Piece squares[SQUARE_NB];
+#endif
+};
+
+#if defined(COPY_MAKE)
+static_assert(sizeof(Board) <= 320, "Board should fit in 5 cache lines");
+#endif
+
 // StateInfo struct stores information needed to restore a Position object to
 // its previous state when we retract a move. Whenever a move is made on the
 // board (by calling Position::do_move), a StateInfo object must be passed.
@@ -51,6 +72,12 @@ struct StateInfo {
     int16_t check10[COLOR_NB];
     int     rule60;
     int     pliesFromNull;
+#if defined(ATTACK_MAPS)
+    Bitboard attacks[COLOR_NB][PIECE_TYPE_NB];  // Squares attacked by the pieces of each type
+#endif
+#if defined(COPY_MAKE)
+    Board board;
+#endif
 
     // Not copied when making a move (will be recomputed anyhow)
     Key        key;
@@ -70,6 +97,25 @@ struct StateInfo {
 };
 
 
+// PackedPosition is a compact fixed-size encoding of a position: one occupancy
+// bit per square followed by one 4-bit piece code per occupied square, both in
+// square order, then the side to move, the rule 60 counter and the game ply.
+struct PackedPosition {
+    uint8_t  occupied[12];
+    uint8_t  pieces[16];
+    uint8_t  sideToMove;
+    uint8_t  rule60;
+    uint16_t gamePly;
+};
+
+static_assert(sizeof(PackedPosition) == 32, "PackedPosition must be 32 bytes");
+
+// Cheap check of a packed position read from a file, which set_packed() needs:
+// pieces only on the board, at most 32 of them with valid codes, one king per
+// side and a valid side to move.
+bool is_ok(const PackedPosition& pp);
+
+
 // A list to keep track of the position states along the setup moves (from the
 // start position to the position just before the search starts). Needed by
 // 'draw by repetition' detection. Use a std::deque because pointers to
@@ -94,6 +140,10 @@ class Position {
     Position&   set(const Position& pos, StateInfo* si);
     std::string fen() const;
 
+    // Packed input/output, faster than FEN strings for bulk processing
+    Position&      set_packed(const PackedPosition& pp, StateInfo* si);
+    PackedPosition pack() const;
+
     // Position representation
     Bitboard pieces(PieceType pt = ALL_PIECES) const;
     template<typename... PieceTypes>
@@ -145,6 +195,7 @@ class Position {
 
     // Accessing hash keys
     Key key() const;
+    Key key_after(Move m) const;
     Key pawn_key() const;
     Key minor_piece_key() const;
     Key defender_piece_key() const;
@@ -173,22 +224,27 @@ class Position {
     // Initialization helpers (used while setting up a position)
     void set_state() const;
     void set_check_info() const;
+    void set_attack_maps() const;
 
     // Other helpers
+    Board&                board();
+    const Board&          board() const;
     void                  move_piece(Square from, Square to);
+    void                  update_attack_maps(Piece pc, Square from, Square to, Piece captured);
     std::pair<Piece, int> light_do_move(Move m);
     void                  light_undo_move(Move m, Piece captured, int id = 0);
+    void                  rollback_move();
     Value                 detect_chases(int d, int ply = 0);
     bool                  chase_legal(Move m) const;
     template<bool AfterMove>
     Key adjust_key60(Key k) const;
+    template<PieceType Pt>
+    Bitboard compute_attacks(Color c) const;
 
     // Data members
-    Piece      board[SQUARE_NB];
-    Bitboard   byTypeBB[PIECE_TYPE_NB];
-    Bitboard   byColorBB[COLOR_NB];
-    Square     kingSquare[COLOR_NB];
-    int        pieceCount[PIECE_NB];
+#if !defined(COPY_MAKE)
+    Board      placement;
+#endif
     StateInfo* st;
     int        gamePly;
     Color      sideToMove;
@@ -206,21 +262,21 @@ inline Color Position::side_to_move() const { return sideToMove; }
 
 inline Piece Position::piece_on(Square s) const {
     assert(is_ok(s));
-    return board[s];
+    return Piece(board().squares[s]);
 }
 
 inline bool Position::empty(Square s) const { return piece_on(s) == NO_PIECE; }
 
 inline Piece Position::moved_piece(Move m) const { return piece_on(m.from_sq()); }
 
-inline Bitboard Position::pieces(PieceType pt) const { return byTypeBB[pt]; }
+inline Bitboard Position::pieces(PieceType pt) const { return board().byTypeBB[pt]; }
 
 template<typename... PieceTypes>
 inline Bitboard Position::pieces(PieceType pt, PieceTypes... pts) const {
     return pieces(pt) | pieces(pts...);
 }
 
-inline Bitboard Position::pieces(Color c) const { return byColorBB[c]; }
+inline Bitboard Position::pieces(Color c) const { return board().byColorBB[c]; }
 
 template<typename... PieceTypes>
 inline Bitboard Position::pieces(Color c, PieceTypes... pts) const {
@@ -229,7 +285,7 @@ inline Bitboard Position::pieces(Color c, PieceTypes... pts) const {
 
 template<PieceType Pt>
 inline int Position::count(Color c) const {
-    return pieceCount[make_piece(c, Pt)];
+    return board().pieceCount[make_piece(c, Pt)];
 }
 
 template<PieceType Pt>
@@ -237,7 +293,7 @@ inline int Position::count() const {
     return count<Pt>(WHITE) + count<Pt>(BLACK);
 }
 
-inline Square Position::king_square(Color c) const { return kingSquare[c]; }
+inline Square Position::king_square(Color c) const { return board().kingSquare[c]; }
 
 inline Bitboard Position::attackers_to(Square s) const { return attackers_to(s, pieces()); }
 
@@ -245,8 +301,19 @@ inline Bitboard Position::checkers_to(Color c, Square s) const {
     return checkers_to(c, s, pieces());
 }
 
+// Squares attacked by the pieces of the given type and color. With -DATTACK_MAPS
+// they are maintained by do_move(), otherwise computed on each call.
 template<PieceType Pt>
 inline Bitboard Position::attacks_by(Color c) const {
+#if defined(ATTACK_MAPS)
+    return st->attacks[c][Pt];
+#else
+    return compute_attacks<Pt>(c);
+#endif
+}
+
+template<PieceType Pt>
+inline Bitboard Position::compute_attacks(Color c) const {
 
     Bitboard threats   = 0;
     Bitboard attackers = pieces(c, Pt);
@@ -297,37 +364,57 @@ inline bool Position::capture(Move m) const {
 
 inline Piece Position::captured_piece() const { return st->capturedPiece; }
 
+inline Board& Position::board() {
+#if defined(COPY_MAKE)
+    return st->board;
+#else
+    return placement;
+#endif
+}
+
+inline const Board& Position::board() const {
+#if defined(COPY_MAKE)
+    return st->board;
+#else
+    return placement;
+#endif
+}
+
 inline void Position::put_piece(Piece pc, Square s) {
 
-    board[s] = pc;
-    byTypeBB[ALL_PIECES] |= byTypeBB[type_of(pc)] |= s;
-    byColorBB[color_of(pc)] |= s;
-    pieceCount[pc]++;
-    pieceCount[make_piece(color_of(pc), ALL_PIECES)]++;
+    Board& b = board();
+
+    b.squares[s] = pc;
+    b.byTypeBB[ALL_PIECES] |= b.byTypeBB[type_of(pc)] |= s;
+    b.byColorBB[color_of(pc)] |= s;
+    b.pieceCount[pc]++;
+    b.pieceCount[make_piece(color_of(pc), ALL_PIECES)]++;
 }
 
 inline void Position::remove_piece(Square s) {
 
-    Piece pc = board[s];
-    byTypeBB[ALL_PIECES] ^= s;
-    byTypeBB[type_of(pc)] ^= s;
-    byColorBB[color_of(pc)] ^= s;
-    board[s] = NO_PIECE;
-    pieceCount[pc]--;
-    pieceCount[make_piece(color_of(pc), ALL_PIECES)]--;
+    Board& b  = board();
+    Piece  pc = Piece(b.squares[s]);
+    b.byTypeBB[ALL_PIECES] ^= s;
+    b.byTypeBB[type_of(pc)] ^= s;
+    b.byColorBB[color_of(pc)] ^= s;
+    b.squares[s] = NO_PIECE;
+    b.pieceCount[pc]--;
+    b.pieceCount[make_piece(color_of(pc), ALL_PIECES)]--;
 }
 
 inline void Position::move_piece(Square from, Square to) {
 
-    Piece    pc     = board[from];
+    Board&   b      = board();
+    Piece    pc     = Piece(b.squares[from]);
     Bitboard fromTo = from | to;
-    byTypeBB[ALL_PIECES] ^= fromTo;
-    byTypeBB[type_of(pc)] ^= fromTo;
-    byColorBB[color_of(pc)] ^= fromTo;
-    board[from] = NO_PIECE;
-    board[to]   = pc;
+    b.byTypeBB[ALL_PIECES] ^= fromTo;
+    b.byTypeBB[type_of(pc)] ^= fromTo;
+    b.byColorBB[color_of(pc)] ^= fromTo;
+    b.squares[from] = NO_PIECE;
+    b.squares[to]   = pc;
     if (type_of(pc) == KING)
-        kingSquare[color_of(pc)] = to;
+        b.kingSquare[color_of(pc)] = to;
 }
 
 inline void Position::do_move(Move m, StateInfo& newSt, const TranspositionTable* tt = nullptr) {
@@ -338,7 +425,7 @@ inline StateInfo* Position::state() const { return st; }
 
 inline Position& Position::set(const Position& pos, StateInfo* si) {
 
-    set(pos.fen(), si);
+    set_packed(pos.pack(), si);
 
     // Special cares for bloom filter
     std::memcpy(&filter, &pos.filter, sizeof(BloomFilter));
@@ -22,6 +22,7 @@
 #include <array>
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
@@ -31,6 +32,7 @@
 
 #include "evaluate.h"
 #include "history.h"
+#include "mate.h"
 #include "misc.h"
 #include "movegen.h"
 #include "movepick.h"
@@ -146,6 +148,25 @@ int stat_malus(Depth d) { return std::min(977 * d - 282, 1524); }
 // Add a small random component to draw evaluations to avoid 3-fold blindness
 Value value_draw(size_t nodes) { return VALUE_DRAW - 1 + Value(nodes & 0x2); }
 
+// Stable insertion sort of root moves. Unlike std::stable_sort it needs no
+// temporary buffer, and the root moves are nearly sorted between iterations.
+void insertion_sort_root_moves(RootMoves::iterator first, RootMoves::iterator last) {
+
+    for (auto it = first; it != last; ++it)
+    {
+        if (it == first || !(*it < *(it - 1)))
+            continue;
+
+        RootMove tmp = *it;
+        auto     q   = it;
+
+        for (; q != first && tmp < *(q - 1); --q)
+            *q = *(q - 1);
+
+        *q = tmp;
+    }
+}
+
 Value value_to_tt(Value v, int ply);
 Value value_from_tt(Value v, int ply, int r60c);
 void  update_pv(Move* pv, Move move, const Move* childPv);
@@ -168,16 +189,28 @@ void update_all_stats(const Position&      pos,
 Search::Worker::Worker(SharedState&                    sharedState,
                        std::unique_ptr<ISearchManager> sm,
                        size_t                          threadId,
-                       NumaReplicatedAccessToken       token) :
+                       NumaReplicatedAccessToken       token,
+                       HistoryTables&                  historyTables,
+                       bool                            clearsHistoryTables) :
+    mainHistory(historyTables.mainHistory),
+    captureHistory(historyTables.captureHistory),
+    pawnHistory(historyTables.pawnHistory),
+    pawnCorrectionHistory(historyTables.pawnCorrectionHistory),
+    minorPieceCorrectionHistory(historyTables.minorPieceCorrectionHistory),
+    nonPawnCorrectionHistory(historyTables.nonPawnCorrectionHistory),
+    continuationCorrectionHistory(historyTables.continuationCorrectionHistory),
     // Unpack the SharedState struct into member variables
     threadIdx(threadId),
     numaAccessToken(token),
+    histories(historyTables),
+    clearsHistories(clearsHistoryTables),
     manager(std::move(sm)),
     options(sharedState.options),
     threads(sharedState.threads),
     tt(sharedState.tt),
     network(sharedState.network),
-    refreshTable(network[token]) {
+    cluster(sharedState.cluster),
+    refreshTable(*network) {
     clear();
 }
 
@@ -200,6 +233,8 @@ void Search::Worker::start_searching() {
                             main_manager()->originalTimeAdjust);
     tt.new_search();
 
+    bool mateSolved = false;
+
     if (rootMoves.empty())
     {
         rootMoves.emplace_back(Move::none());
@@ -207,8 +242,13 @@ void Search::Worker::start_searching() {
     }
     else
     {
-        threads.start_searching();  // start non-main threads
-        iterative_deepening();      // main thread start searching
+        mateSolved = limits.mate && solve_mate();
+
+        if (!mateSolved)
+        {
+            threads.start_searching();  // start non-main threads
+            iterative_deepening();      // main thread start searching
+        }
     }
 
     // When we reach the maximum depth, we can arrive here without a raise of
@@ -219,6 +259,8 @@ void Search::Worker::start_searching() {
     while (!threads.stop && (main_manager()->ponder || limits.infinite))
     {}  // Busy wait for a stop or a ponder reset
 
+    const auto searchEnd = std::chrono::steady_clock::now();
+
     // Stop the threads if not already stopped (also raise the stop if
     // "ponderhit" just reset threads.ponder).
     threads.stop = true;
@@ -234,7 +276,8 @@ void Search::Worker::start_searching() {
 
     Worker* bestThread = this;
 
-    if (int(options["MultiPV"]) == 1 && !limits.depth && rootMoves[0].pv[0] != Move::none())
+    if (int(options["MultiPV"]) == 1 && !limits.depth && !mateSolved
+        && rootMoves[0].pv[0] != Move::none())
         bestThread = threads.get_best_thread()->worker.get();
 
     main_manager()->bestPreviousScore        = bestThread->rootMoves[0].score;
@@ -244,16 +287,90 @@ void Search::Worker::start_searching() {
     if (bestThread != this)
         main_manager()->pv(*bestThread, threads, tt, bestThread->completedDepth);
 
+    RootMove* best = &bestThread->rootMoves[0];
+    RootMove  voted(Move::none());
+
+    // Let the other instances of a cluster vote for the best move
+    if (cluster.active() && !mateSolved && best->pv[0] != Move::none())
+    {
+        const Move m =
+          cluster.vote({rootPos.key(), best->pv[0], best->score, bestThread->completedDepth});
+
+        if (m != best->pv[0] && std::find(rootMoves.begin(), rootMoves.end(), m) != rootMoves.end())
+            best = &(voted = RootMove(m));
+
+        sync_cout << "info string " << cluster.stats() << sync_endl;
+    }
+
     std::string ponder;
 
-    if (bestThread->rootMoves[0].pv.size() > 1
-        || bestThread->rootMoves[0].extract_ponder_from_tt(tt, rootPos))
-        ponder = UCIEngine::move(bestThread->rootMoves[0].pv[1]);
+    if (best->pv.size() > 1 || best->extract_ponder_from_tt(tt, rootPos))
+        ponder = UCIEngine::move(best->pv[1]);
 
-    auto bestmove = UCIEngine::move(bestThread->rootMoves[0].pv[0]);
+    auto bestmove = UCIEngine::move(best->pv[0]);
+
+    main_manager()->bestmoveLatency = std::chrono::duration_cast<std::chrono::microseconds>(
+                                        std::chrono::steady_clock::now() - searchEnd)
+                                        .count();
     main_manager()->updates.onBestmove(bestmove, ponder);
 }
 
+// Looks for a mate in limits.mate moves with the mate solver, which proves long
+// forced mates much faster than the alpha-beta search. Returns true if one was
+// found, the mating line being then the PV of the first root move.
+bool Search::Worker::solve_mate() {
+
+    SearchManager* mainManager = main_manager();
+    bool           found       = false;
+
+    mainManager->mateSolver.clear();
+
+    auto stop = [&]() {
+        return threads.stop || (!mainManager->ponder && mainManager->limits_reached(*this));
+    };
+
+    auto onProof = [&](const Mate::Result& result) {
+        auto rm = std::find(rootMoves.begin(), rootMoves.end(), result.pv[0]);
+        if (rm == rootMoves.end())
+            return;
+
+        std::rotate(rootMoves.begin(), rm, rm + 1);
+        rootMoves[0].score = rootMoves[0].uciScore = mate_in(int(result.pv.size()));
+        rootMoves[0].selDepth                      = int(result.pv.size());
+        rootMoves[0].pv.resize(0);
+        for (Move m : result.pv)
+            rootMoves[0].pv.push_back(m);
+
+        found = true;
+        mainManager->pv(*this, threads, tt, int(result.pv.size()));
+
+        sync_cout << "info string Mate in " << (result.pv.size() + 1) / 2 << " proven by "
+                  << result.proofSize << " positions" << sync_endl;
+    };
+
+    mainManager->mateSolver.solve(rootPos, limits.mate, nodes, stop, onProof);
+    return found;
+}
+
+// Replaces the vote of the thread for the best thread selection by one for its
+// current best move, weighted by its score and completed depth. Tallying the
+// votes as the threads complete iterations spares ThreadPool::get_best_thread()
+// a pass over all threads to collect them once the search has stopped.
+void Search::Worker::publish_vote() {
+
+    RootMoveStats& previous = threads.rootMoveStats[voteIdx];
+    previous.voteScore.fetch_sub(voteScore, std::memory_order_relaxed);
+    previous.voteDepth.fetch_sub(voteDepth, std::memory_order_relaxed);
+
+    voteIdx   = rootMoves[0].statsIdx;
+    voteScore = int64_t(rootMoves[0].score) * completedDepth;
+    voteDepth = completedDepth;
+
+    RootMoveStats& current = threads.rootMoveStats[voteIdx];
+    current.voteScore.fetch_add(voteScore, std::memory_order_relaxed);
+    current.voteDepth.fetch_add(voteDepth, std::memory_order_relaxed);
+}
+
 // Main iterative deepening loop. It calls search()
 // repeatedly with increasing depth until the allocated thinking time has been
 // consumed, the user stops the search, or the maximum search depth is reached.
@@ -265,7 +382,7 @@ void Search::Worker::iterative_deepening() {
 
     Depth lastBestMoveDepth = 0;
     Value lastBestScore     = -VALUE_INFINITE;
-    auto  lastBestPV        = std::vector{Move::none()};
+    auto  lastBestPV        = PVLine(Move::none());
 
     Value  alpha, beta;
     Value  bestValue     = -VALUE_INFINITE;
@@ -366,7 +483,7 @@ void Search::Worker::iterative_deepening() {
                 // and we want to keep the same order for all the moves except the
                 // new PV that goes to the front. Note that in the case of MultiPV
                 // search the already searched PV lines are preserved.
-                std::stable_sort(rootMoves.begin() + pvIdx, rootMoves.begin() + pvLast);
+                insertion_sort_root_moves(rootMoves.begin() + pvIdx, rootMoves.begin() + pvLast);
 
                 // If search has been stopped, we break immediately. Sorting is
                 // safe because RootMoves is still valid, although it refers to
@@ -406,7 +523,7 @@ void Search::Worker::iterative_deepening() {
             }
 
             // Sort the PV lines searched so far and update the GUI
-            std::stable_sort(rootMoves.begin() + pvFirst, rootMoves.begin() + pvIdx + 1);
+            insertion_sort_root_moves(rootMoves.begin() + pvFirst, rootMoves.begin() + pvIdx + 1);
 
             if (mainThread
                 && (threads.stop || pvIdx + 1 == multiPV || nodes > 10000000)
@@ -443,6 +560,12 @@ void Search::Worker::iterative_deepening() {
             lastBestMoveDepth = rootDepth;
         }
 
+        publish_vote();
+
+        if (mainThread && cluster.active() && completedDepth)
+            cluster.share_root(
+              {rootPos.key(), rootMoves[0].pv[0], rootMoves[0].score, completedDepth});
+
         if (!mainThread)
             continue;
 
@@ -512,10 +635,9 @@ void Search::Worker::iterative_deepening() {
     mainThread->previousTimeReduction = timeReduction;
 }
 
-// Reset histories, usually before a new game
-void Search::Worker::clear() {
+// Reset the history tables a worker may share with others
+void HistoryTables::clear() {
     mainHistory.fill(61);
-    lowPlyHistory.fill(106);
     captureHistory.fill(-598);
     pawnHistory.fill(-1181);
     pawnCorrectionHistory.fill(0);
@@ -526,6 +648,14 @@ void Search::Worker::clear() {
     for (auto& to : continuationCorrectionHistory)
         for (auto& h : to)
             h.fill(0);
+}
+
+// Reset histories, usually before a new game
+void Search::Worker::clear() {
+    if (clearsHistories)
+        histories.clear();
+
+    lowPlyHistory.fill(106);
 
     for (bool inCheck : {false, true})
         for (StatsType c : {NoCaptures, Captures})
@@ -536,7 +666,9 @@ void Search::Worker::clear() {
     for (size_t i = 1; i < reductions.size(); ++i)
         reductions[i] = int(1460 / 100.0 * std::log(i));
 
-    refreshTable.clear(network[numaAccessToken]);
+    // The biases are the same in all the replicas of the network, which are
+    // only made by ensure_network_replicated() or the first evaluation
+    refreshTable.clear(*network);
 }
 
 
@@ -654,7 +786,7 @@ Value Search::Worker::search(
     ss->ttPv     = excludedMove ? ss->ttPv : PvNode || (ttHit && ttData.is_pv);
     ttCapture    = ttData.move && pos.capture(ttData.move);
 
-    // At this point, if excluded, skip straight to step 5, static eval. However,
+    // At this point, if excluded, skip straight to step 6, static eval. However,
     // to save indentation, we list the condition in all code between here and there.
 
     // At non-PV nodes we check for an early TT cutoff
@@ -682,7 +814,30 @@ Value Search::Worker::search(
             return ttData.value;
     }
 
-    // Step 5. Static evaluation of the position
+    // Step 5. Tablebases probe
+    if (!rootNode && !excludedMove && tbConfig.cardinality)
+    {
+        int piecesCount = pos.count<ALL_PIECES>();
+
+        if (piecesCount <= tbConfig.cardinality && depth >= tbConfig.probeDepth)
+        {
+            value = Tablebases::probe(pos, ss->ply);
+
+            // A mate from the tables is exact, so there is nothing left to search
+            if (value != VALUE_NONE)
+            {
+                thisThread->tbHits.fetch_add(1, std::memory_order_relaxed);
+
+                ttWriter.write(posKey, value_to_tt(value, ss->ply), ss->ttPv, BOUND_EXACT,
+                               std::min(MAX_PLY - 1, depth + 6), Move::none(), VALUE_NONE,
+                               tt.generation());
+
+                return value;
+            }
+        }
+    }
+
+    // Step 6. Static evaluation of the position
     Value      unadjustedStaticEval = VALUE_NONE;
     const auto correctionValue      = correction_value(*thisThread, pos, ss);
     if (ss->inCheck)
@@ -744,13 +899,13 @@ Value Search::Worker::search(
     if (priorReduction >= 1 && depth >= 2 && ss->staticEval + (ss - 1)->staticEval > 200)
         depth--;
 
-    // Step 6. Razoring
+    // Step 7. Razoring
     // If eval is really low, skip search entirely and return the qsearch value.
     // For PvNodes, we must have a guard against mates being returned.
     if (!PvNode && eval < alpha - 1373 - 252 * depth * depth)
         return qsearch<NonPV>(pos, ss, alpha, beta);
 
-    // Step 7. Futility pruning: child node
+    // Step 8. Futility pruning: child node
     // The depth condition is important for mate finding.
     if (!ss->ttPv && depth < 16
         && eval - futility_margin(depth, cutNode && !ss->ttHit, improving, opponentWorsening)
@@ -759,7 +914,7 @@ Value Search::Worker::search(
         && eval >= beta && (!ttData.move || ttCapture) && !is_loss(beta) && !is_win(eval))
         return beta + (eval - beta) / 3;
 
-    // Step 8. Null move search with verification search
+    // Step 9. Null move search with verification search
     if (cutNode && (ss - 1)->currentMove != Move::null() && eval >= beta
         && ss->staticEval >= beta - 8 * depth + 179 - 20 * improving && !excludedMove
         && pos.major_material(us) && ss->ply >= thisThread->nmpMinPly && !is_loss(beta))
@@ -802,13 +957,13 @@ Value Search::Worker::search(
 
     improving |= ss->staticEval >= beta + 113;
 
-    // Step 9. Internal iterative reductions
+    // Step 10. Internal iterative reductions
     // For PV nodes without a ttMove as well as for deep enough cutNodes, we decrease depth.
     // (* Scaler) Especially if they make IIR more aggressive.
     if (((PvNode || cutNode) && depth >= 7 - 3 * PvNode) && !ttData.move)
         depth--;
 
-    // Step 10. ProbCut
+    // Step 11. ProbCut
     // If we have a good enough capture and a reduced search
     // returns a value much above beta, we can (almost) safely prune the previous move.
     probCutBeta = beta + 234 - 66 * improving;
@@ -873,7 +1028,7 @@ Value Search::Worker::search(
 
 moves_loop:  // When in check, search starts here
 
-    // Step 11. A small Probcut idea
+    // Step 12. A small Probcut idea
     probCutBeta = beta + 441;
     if ((ttData.bound & BOUND_LOWER) && ttData.depth >= depth - 3 && ttData.value >= probCutBeta
         && !is_decisive(beta) && is_valid(ttData.value) && !is_decisive(ttData.value))
@@ -886,12 +1041,13 @@ moves_loop:  // When in check, search starts here
 
     MovePicker mp(pos, ttData.move, depth, &thisThread->mainHistory, &thisThread->lowPlyHistory,
                   &thisThread->captureHistory, contHist, &thisThread->pawnHistory, ss->ply);
+    mp.prefetch_ahead(&tt, ttProbeAhead);
 
     value = bestValue;
 
     int moveCount = 0;
 
-    // Step 12. Loop through all pseudo-legal moves until no moves remain
+    // Step 13. Loop through all pseudo-legal moves until no moves remain
     // or a beta cutoff occurs.
     while ((move = mp.next_move()) != Move::none())
     {
@@ -942,7 +1098,7 @@ moves_loop:  // When in check, search starts here
         if (ss->ttPv)
             r += 1024;
 
-        // Step 13. Pruning at shallow depth.
+        // Step 14. Pruning at shallow depth.
         // Depth conditions are important for mate finding.
         if (!rootNode && pos.major_material(us) && !is_loss(bestValue))
         {
@@ -1012,7 +1168,7 @@ moves_loop:  // When in check, search starts here
             }
         }
 
-        // Step 14. Extensions
+        // Step 15. Extensions
         // We take care to not overdo to avoid search getting stuck.
         if (ss->ply < thisThread->rootDepth * 2)
         {
@@ -1080,7 +1236,7 @@ moves_loop:  // When in check, search starts here
             }
         }
 
-        // Step 15. Make the move
+        // Step 16. Make the move
         pos.do_move(move, st, givesCheck, &tt);
         thisThread->nodes.fetch_add(1, std::memory_order_relaxed);
 
@@ -1096,6 +1252,24 @@ moves_loop:  // When in check, search starts here
           &thisThread->continuationCorrectionHistory[movedPiece][move.to_sq()];
         uint64_t nodeCount = rootNode ? uint64_t(nodes) : 0;
 
+        // At the root, helper threads reduce moves which another thread has
+        // already searched at this depth, so that the threads spread over the
+        // root moves instead of duplicating work.
+        RootMove*      rootMove  = nullptr;
+        RootMoveStats* rootStats = nullptr;
+        bool           duplicate = false;
+
+        if (rootNode)
+        {
+            rootMove  = &*std::find(rootMoves.begin(), rootMoves.end(), move);
+            rootStats = &threads.rootMoveStats[rootMove->statsIdx];
+            duplicate = rootStats->depth.load(std::memory_order_relaxed) >= depth
+                     && rootStats->owner.load(std::memory_order_relaxed) != int(threadIdx);
+
+            if (!is_mainthread() && moveCount > 1 && duplicate)
+                r += 1024;
+        }
+
         // Decrease reduction for PvNodes (*Scaler)
         if (ss->ttPv)
             r -= 2048 + PvNode * 1024 + (ttData.value > alpha) * 1024
@@ -1139,7 +1313,7 @@ moves_loop:  // When in check, search starts here
         // Decrease/increase reduction for moves with a good/bad history
         r -= ss->statScore * 2652 / 18912;
 
-        // Step 16. Late moves reduction / extension (LMR)
+        // Step 17. Late moves reduction / extension (LMR)
         if (depth >= 2 && moveCount > 1)
         {
             // In general we want to cap the LMR depth search at newDepth, but when
@@ -1179,7 +1353,7 @@ moves_loop:  // When in check, search starts here
                 newDepth--;
         }
 
-        // Step 17. Full-depth search when LMR is skipped
+        // Step 18. Full-depth search when LMR is skipped
         else if (!PvNode || moveCount > 1)
         {
             // Increase reduction if ttMove is not present
@@ -1205,12 +1379,30 @@ moves_loop:  // When in check, search starts here
             value = -search<PV>(pos, ss + 1, -beta, -alpha, newDepth, false);
         }
 
-        // Step 18. Undo move
+        // Step 19. Undo move
         pos.undo_move(move);
 
+        if (rootNode)
+        {
+            const uint64_t moveNodes = nodes - nodeCount;
+
+            threads.rootNodes.fetch_add(moveNodes, std::memory_order_relaxed);
+            if (duplicate)
+                threads.duplicateRootNodes.fetch_add(moveNodes, std::memory_order_relaxed);
+
+            // Record a completed search deeper than any before. A race between
+            // threads can only lose an equally valid record.
+            if (!threads.stop.load(std::memory_order_relaxed)
+                && rootStats->depth.load(std::memory_order_relaxed) < depth)
+            {
+                rootStats->depth.store(depth, std::memory_order_relaxed);
+                rootStats->owner.store(int(threadIdx), std::memory_order_relaxed);
+            }
+        }
+
         assert(value > -VALUE_INFINITE && value < VALUE_INFINITE);
 
-        // Step 19. Check for a new best move
+        // Step 20. Check for a new best move
         // Finished searching the move. If a stop occurred, the return value of
         // the search cannot be trusted, and we return immediately without updating
         // best move, principal variation nor transposition table.
@@ -1219,8 +1411,7 @@ moves_loop:  // When in check, search starts here
 
         if (rootNode)
         {
-            RootMove& rm =
-              *std::find(thisThread->rootMoves.begin(), thisThread->rootMoves.end(), move);
+            RootMove& rm = *rootMove;
 
             rm.effort += nodes - nodeCount;
 
@@ -1315,7 +1506,7 @@ moves_loop:  // When in check, search starts here
         }
     }
 
-    // Step 20. Check for mate
+    // Step 21. Check for mate
     // All legal moves have been searched and if there are no legal moves,
     // it must be a mate. If we are in a singular extension search then
     // return a fail low score.
@@ -1380,11 +1571,19 @@ moves_loop:  // When in check, search starts here
     // Write gathered information in transposition table. Note that the
     // static evaluation is saved as it was before correction history.
     if (!excludedMove && !(rootNode && thisThread->pvIdx))
-        ttWriter.write(posKey, value_to_tt(bestValue, ss->ply), ss->ttPv,
-                       bestValue >= beta    ? BOUND_LOWER
-                       : PvNode && bestMove ? BOUND_EXACT
-                                            : BOUND_UPPER,
-                       depth, bestMove, unadjustedStaticEval, tt.generation());
+    {
+        const Bound bound = bestValue >= beta    ? BOUND_LOWER
+                          : PvNode && bestMove ? BOUND_EXACT
+                                               : BOUND_UPPER;
+
+        ttWriter.write(posKey, value_to_tt(bestValue, ss->ply), ss->ttPv, bound, depth, bestMove,
+                       unadjustedStaticEval, tt.generation());
+
+        // Deep results are worth sending to the other instances of a cluster
+        if (depth >= cluster.min_depth())
+            cluster.share_entry(threadIdx, posKey, value_to_tt(bestValue, ss->ply), ss->ttPv,
+                                bound, depth, bestMove, unadjustedStaticEval);
+    }
 
     // Adjust correction history
     if (!ss->inCheck && !(bestMove && pos.capture(bestMove))
@@ -1542,6 +1741,7 @@ Value Search::Worker::qsearch(Position& pos, Stack* ss, Value alpha, Value beta)
     // captures, or evasions only when in check.
     MovePicker mp(pos, ttData.move, DEPTH_QS, &thisThread->mainHistory, &thisThread->lowPlyHistory,
                   &thisThread->captureHistory, contHist, &thisThread->pawnHistory, ss->ply);
+    mp.prefetch_ahead(&tt, ttProbeAhead);
 
     // Step 5. Loop through all pseudo-legal moves until no moves remain or a beta
     // cutoff occurs.
@@ -1828,20 +2028,28 @@ void SearchManager::check_time(Search::Worker& worker) {
         dbg_print();
     }
 
+    worker.cluster.apply_received();
+
     // We should not stop pondering until told so by the GUI
     if (ponder)
         return;
 
-    if (
-      // Later we rely on the fact that we can at least use the mainthread previous
-      // root-search score and PV in a multithreaded environment to prove mated-in scores.
-      worker.completedDepth >= 1
-      && ((worker.limits.use_time_management() && (elapsed > tm.maximum() || stopOnPonderhit))
-          || (worker.limits.movetime && elapsed >= worker.limits.movetime)
-          || (worker.limits.nodes && worker.threads.nodes_searched() >= worker.limits.nodes)))
+    // Later we rely on the fact that we can at least use the mainthread previous
+    // root-search score and PV in a multithreaded environment to prove mated-in scores.
+    if (worker.completedDepth >= 1 && limits_reached(worker))
         worker.threads.stop = worker.threads.abortedSearch = true;
 }
 
+// Tells whether the time or the nodes given to the search are used up
+bool SearchManager::limits_reached(const Search::Worker& worker) const {
+
+    TimePoint elapsed = tm.elapsed([&worker]() { return worker.threads.nodes_searched(); });
+
+    return (worker.limits.use_time_management() && (elapsed > tm.maximum() || stopOnPonderhit))
+        || (worker.limits.movetime && elapsed >= worker.limits.movetime)
+        || (worker.limits.nodes && worker.threads.nodes_searched() >= worker.limits.nodes);
+}
+
 void SearchManager::pv(const Search::Worker&     worker,
                        const ThreadPool&         threads,
                        const TranspositionTable& tt,
@@ -1894,7 +2102,7 @@ void SearchManager::pv(const Search::Worker&     worker,
         info.timeMs    = time;
         info.nodes     = nodes;
         info.nps       = nodes * 1000 / time;
-        info.tbHits    = 0;
+        info.tbHits    = threads.tb_hits();
         info.pv        = pv;
         info.hashfull  = tt.hashfull();
 
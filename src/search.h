@@ -19,6 +19,7 @@
 #ifndef SEARCH_H_INCLUDED
 #define SEARCH_H_INCLUDED
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cassert>
@@ -30,13 +31,16 @@
 #include <string_view>
 #include <vector>
 
+#include "distributed.h"
 #include "history.h"
+#include "mate.h"
 #include "misc.h"
 #include "nnue/network.h"
 #include "nnue/nnue_accumulator.h"
 #include "numa.h"
 #include "position.h"
 #include "score.h"
+#include "tablebase.h"
 #include "timeman.h"
 #include "types.h"
 
@@ -77,13 +81,54 @@ struct Stack {
 };
 
 
+// PVLine is a fixed-capacity PV stored inline, so that root moves can be copied
+// and their PVs updated without any heap allocation. Only the used part of the
+// line is copied.
+class PVLine {
+   public:
+    PVLine() = default;
+    explicit PVLine(Move m) :
+        len(1) {
+        moves[0] = m;
+    }
+
+    PVLine(const PVLine& other) { *this = other; }
+    PVLine& operator=(const PVLine& other) {
+        len = other.len;
+        std::copy(other.begin(), other.end(), moves.begin());
+        return *this;
+    }
+
+    size_t      size() const { return len; }
+    bool        empty() const { return len == 0; }
+    Move        operator[](size_t i) const { return moves[i]; }
+    Move&       operator[](size_t i) { return moves[i]; }
+    const Move* begin() const { return moves.data(); }
+    const Move* end() const { return moves.data() + len; }
+
+    void push_back(Move m) {
+        assert(len < moves.size());
+        moves[len++] = m;
+    }
+
+    void resize(size_t n) {
+        assert(n <= moves.size());
+        len = n;
+    }
+
+   private:
+    std::array<Move, MAX_PLY + 1> moves;
+    size_t                        len = 0;
+};
+
+
 // RootMove struct is used for moves at the root of the tree. For each root move
 // we store a score and a PV (really a refutation in the case of moves which
 // fail low). Score is normally set at -VALUE_INFINITE for all non-pv moves.
 struct RootMove {
 
     explicit RootMove(Move m) :
-        pv(1, m) {}
+        pv(m) {}
     bool extract_ponder_from_tt(const TranspositionTable& tt, Position& pos);
     bool operator==(const Move& m) const { return pv[0] == m; }
     // Sort in descending order
@@ -91,21 +136,33 @@ struct RootMove {
         return m.score != score ? m.score < score : m.previousScore < previousScore;
     }
 
-    uint64_t          effort           = 0;
-    Value             score            = -VALUE_INFINITE;
-    Value             previousScore    = -VALUE_INFINITE;
-    Value             averageScore     = -VALUE_INFINITE;
-    Value             meanSquaredScore = -VALUE_INFINITE * VALUE_INFINITE;
-    Value             uciScore         = -VALUE_INFINITE;
-    bool              scoreLowerbound  = false;
-    bool              scoreUpperbound  = false;
-    int               selDepth         = 0;
-    std::vector<Move> pv;
+    uint64_t effort           = 0;
+    Value    score            = -VALUE_INFINITE;
+    Value    previousScore    = -VALUE_INFINITE;
+    Value    averageScore     = -VALUE_INFINITE;
+    Value    meanSquaredScore = -VALUE_INFINITE * VALUE_INFINITE;
+    Value    uciScore         = -VALUE_INFINITE;
+    bool     scoreLowerbound  = false;
+    bool     scoreUpperbound  = false;
+    int      selDepth         = 0;
+    size_t   statsIdx         = 0;  // Index in the root move statistics of the pool
+    PVLine   pv;
 };
 
 using RootMoves = std::vector<RootMove>;
 
 
+// RootMoveStats holds what the threads of a pool know about one root move. It
+// is shared by all of them and updated without locks, so that helper threads
+// can steer their effort toward root moves that are less explored.
+struct RootMoveStats {
+    std::atomic<int>     depth;      // Deepest completed search of the move
+    std::atomic<int>     owner;      // Thread which completed that search
+    std::atomic<int64_t> voteScore;  // Sum of score * depth of the threads voting for it
+    std::atomic<int64_t> voteDepth;  // Sum of depth of the threads voting for it
+};
+
+
 // LimitsType struct stores information sent by the caller about the analysis required.
 struct LimitsType {
 
@@ -133,16 +190,19 @@ struct SharedState {
     SharedState(const OptionsMap&                              optionsMap,
                 ThreadPool&                                    threadPool,
                 TranspositionTable&                            transpositionTable,
-                const LazyNumaReplicated<Eval::NNUE::Network>& net) :
+                const LazyNumaReplicated<Eval::NNUE::Network>& net,
+                Distributed::Node&                             clusterNode) :
         options(optionsMap),
         threads(threadPool),
         tt(transpositionTable),
-        network(net) {}
+        network(net),
+        cluster(clusterNode) {}
 
     const OptionsMap&                              options;
     ThreadPool&                                    threads;
     TranspositionTable&                            tt;
     const LazyNumaReplicated<Eval::NNUE::Network>& network;
+    Distributed::Node&                             cluster;
 };
 
 class Worker;
@@ -200,6 +260,7 @@ class SearchManager: public ISearchManager {
         updates(updateContext) {}
 
     void check_time(Search::Worker& worker) override;
+    bool limits_reached(const Search::Worker& worker) const;
 
     void pv(const Search::Worker&     worker,
             const ThreadPool&         threads,
@@ -217,6 +278,12 @@ class SearchManager: public ISearchManager {
     Value                bestPreviousAverageScore;
     bool                 stopOnPonderhit;
 
+    // Time from the end of the search of the main thread to the bestmove of
+    // the last search, in microseconds
+    int64_t bestmoveLatency;
+
+    Mate::Solver mateSolver;
+
     size_t id;
 
     const UpdateContext& updates;
@@ -233,7 +300,12 @@ class NullSearchManager: public ISearchManager {
 // of the search history, and storing data required for the search.
 class Worker {
    public:
-    Worker(SharedState&, std::unique_ptr<ISearchManager>, size_t, NumaReplicatedAccessToken);
+    Worker(SharedState&,
+           std::unique_ptr<ISearchManager>,
+           size_t,
+           NumaReplicatedAccessToken,
+           HistoryTables&,
+           bool);
 
     // Called at instantiation to initialize reductions tables.
     // Reset histories, usually before a new game.
@@ -247,18 +319,22 @@ class Worker {
 
     void ensure_network_replicated();
 
-    // Public because they need to be updatable by the stats
-    ButterflyHistory mainHistory;
-    LowPlyHistory    lowPlyHistory;
+    // Best root move of the last search, for tools driving the search directly
+    const RootMove& best_root_move() const { return rootMoves[0]; }
 
-    CapturePieceToHistory captureHistory;
-    ContinuationHistory   continuationHistory[2][2];
-    PawnHistory           pawnHistory;
+    // Public because they need to be updatable by the stats. The tables of
+    // HistoryTables may be shared with other workers, see ThreadPool::set().
+    ButterflyHistory& mainHistory;
+    LowPlyHistory     lowPlyHistory;
 
-    CorrectionHistory<Pawn>         pawnCorrectionHistory;
-    CorrectionHistory<Minor>        minorPieceCorrectionHistory;
-    CorrectionHistory<NonPawn>      nonPawnCorrectionHistory[COLOR_NB];
-    CorrectionHistory<Continuation> continuationCorrectionHistory;
+    CapturePieceToHistory& captureHistory;
+    ContinuationHistory    continuationHistory[2][2];
+    PawnHistory&           pawnHistory;
+
+    CorrectionHistory<Pawn>&         pawnCorrectionHistory;
+    CorrectionHistory<Minor>&        minorPieceCorrectionHistory;
+    CorrectionHistory<NonPawn> (&nonPawnCorrectionHistory)[COLOR_NB];
+    CorrectionHistory<Continuation>& continuationCorrectionHistory;
 
    private:
     void iterative_deepening();
@@ -284,10 +360,13 @@ class Worker {
 
     Value evaluate(const Position&);
 
+    void publish_vote();
+    bool solve_mate();
+
     LimitsType limits;
 
     size_t                pvIdx, pvLast;
-    std::atomic<uint64_t> nodes, bestMoveChanges;
+    std::atomic<uint64_t> nodes, tbHits, bestMoveChanges;
     int                   selDepth, nmpMinPly;
 
     Value optimism[COLOR_NB];
@@ -298,9 +377,24 @@ class Worker {
     Depth     rootDepth, completedDepth;
     Value     rootDelta;
 
+    // Vote of this thread for the best thread selection, as last published in
+    // the root move statistics of the pool
+    size_t  voteIdx;
+    int64_t voteScore;
+    Depth   voteDepth;
+
     size_t                    threadIdx;
     NumaReplicatedAccessToken numaAccessToken;
 
+    Tablebases::Config tbConfig;
+
+    HistoryTables& histories;
+    bool           clearsHistories;  // False if another worker clears the shared tables
+
+    // Number of moves following the one being searched whose transposition
+    // table entries are prefetched, see MovePicker::prefetch_ahead()
+    int ttProbeAhead = 0;
+
     // Reductions lookup table initialized at startup
     std::array<int, MAX_PLY + 10> reductions;  // [depth or moveNumber]
 
@@ -311,6 +405,7 @@ class Worker {
     ThreadPool&                                    threads;
     TranspositionTable&                            tt;
     const LazyNumaReplicated<Eval::NNUE::Network>& network;
+    Distributed::Node&                             cluster;
 
     // Used by NNUE
     Eval::NNUE::AccumulatorCaches refreshTable;
@@ -0,0 +1,884 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2025 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tablebase.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "bitboard.h"
+#include "misc.h"
+#include "position.h"
+#include "search.h"
+#include "ucioption.h"
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#else
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#endif
+
+namespace Stockfish::Tablebases {
+
+int MaxCardinality;
+
+namespace {
+
+constexpr int      MaxPieces       = 6;           // Largest tables looked for and generated
+constexpr uint8_t  DTMUnknown      = 255;         // Mate too long to be stored in a byte
+constexpr uint16_t Illegal         = 0xFFFF;      // Marks illegal positions while generating
+constexpr uint32_t Magic           = 0x42544650;  // "PFTB"
+constexpr uint32_t Version         = 1;
+constexpr uint64_t GenerateStep    = 4096;  // Positions handed out to a generating thread at once
+constexpr uint64_t MaxGenerateSize = uint64_t(1) << 30;  // Positions of the largest table built
+
+constexpr int NotFound = -2, Drawn = -1;
+
+constexpr std::string_view PieceToChar(" RACPNBK");
+constexpr PieceType        SignatureOrder[] = {ROOK, CANNON, KNIGHT, PAWN, ADVISOR, BISHOP};
+
+#ifdef _WIN32
+constexpr char PathSeparator = ';';
+#else
+constexpr char PathSeparator = ':';
+#endif
+
+// The file header, followed by one byte per position: 0 for a draw, else the
+// distance to mate in plies plus one, which is odd when the side to move wins.
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size;
+    uint32_t maxDTM;
+    char     name[12];
+};
+
+static_assert(sizeof(Header) == 32, "Header must be 32 bytes");
+
+// Squares a piece can stand on, numbered. The white king is restricted to the
+// files D and E, positions with it on file F being mirrored.
+struct Domain {
+    int     size;
+    uint8_t index[SQUARE_NB];
+    Square  square[SQUARE_NB];
+};
+
+Domain Domains[PIECE_NB];
+
+// The material of one side besides its king, in signature order
+using Side = std::vector<PieceType>;
+
+// A table, either mapped from a file or generated in this session
+struct Table {
+    Table() = default;
+    Table(const Table&)            = delete;
+    Table& operator=(const Table&) = delete;
+    ~Table();
+
+    std::string    name;
+    Piece          pieces[MaxPieces];  // Both kings first, then in signature order
+    int            pieceCount;
+    uint64_t       code;
+    uint64_t       size;
+    int            maxDTM;
+    const uint8_t* data = nullptr;
+
+    std::vector<uint8_t> memory;
+    const void*          mapping    = nullptr;
+    size_t               mappedSize = 0;
+};
+
+std::vector<std::unique_ptr<Table>> Tables;
+
+// The tables by material code, with whether the colors of the position must be
+// flipped to match the table.
+std::unordered_map<uint64_t, std::pair<const Table*, bool>> Lookup;
+
+
+const uint8_t* map_file(const std::string& file, size_t& size) {
+
+#ifndef _WIN32
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd == -1)
+        return nullptr;
+
+    struct stat statbuf;
+    if (fstat(fd, &statbuf) || statbuf.st_size < off_t(sizeof(Header)))
+    {
+        ::close(fd);
+        return nullptr;
+    }
+
+    size       = size_t(statbuf.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    return data == MAP_FAILED ? nullptr : static_cast<const uint8_t*>(data);
+#else
+    HANDLE fd = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (fd == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    DWORD sizeHigh;
+    DWORD sizeLow = GetFileSize(fd, &sizeHigh);
+    size          = size_t(uint64_t(sizeHigh) << 32 | sizeLow);
+
+    HANDLE mapping = size >= sizeof(Header)
+                     ? CreateFileMapping(fd, nullptr, PAGE_READONLY, sizeHigh, sizeLow, nullptr)
+                     : nullptr;
+    CloseHandle(fd);
+    if (!mapping)
+        return nullptr;
+
+    // The view keeps the mapping alive after its handle is closed
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+
+    return static_cast<const uint8_t*>(data);
+#endif
+}
+
+Table::~Table() {
+
+    if (!mapping)
+        return;
+
+#ifndef _WIN32
+    munmap(const_cast<void*>(mapping), mappedSize);
+#else
+    UnmapViewOfFile(mapping);
+#endif
+}
+
+
+void init_domains() {
+
+    const Bitboard allSquares = HalfBB[WHITE] | HalfBB[BLACK];
+    const Bitboard advisors   = SQ_D0 | SQ_F0 | SQ_E1 | SQ_D2 | SQ_F2;
+    const Bitboard bishops    = SQ_C0 | SQ_G0 | SQ_A2 | SQ_E2 | SQ_I2 | SQ_C4 | SQ_G4;
+
+    for (Color c : {WHITE, BLACK})
+        for (PieceType pt : {ROOK, ADVISOR, CANNON, PAWN, KNIGHT, BISHOP, KING})
+        {
+            Bitboard b = pt == KING    ? Palace & HalfBB[c]
+                       : pt == ADVISOR ? advisors
+                       : pt == BISHOP  ? bishops
+                       : pt == PAWN    ? PawnBB[c]
+                                       : allSquares;
+
+            // Advisors and bishops are given for white and flipped for black
+            if (c == BLACK && (pt == ADVISOR || pt == BISHOP))
+            {
+                Bitboard flipped = 0;
+                while (b)
+                    flipped |= flip_rank(pop_lsb(b));
+                b = flipped;
+            }
+
+            if (c == WHITE && pt == KING)
+                b &= FileDBB | FileEBB;
+
+            Domain& d = Domains[make_piece(c, pt)];
+            d.size    = 0;
+            std::memset(d.index, 0, sizeof(d.index));
+
+            while (b)
+            {
+                Square s          = pop_lsb(b);
+                d.index[s]        = uint8_t(d.size);
+                d.square[d.size++] = s;
+            }
+        }
+}
+
+
+std::string side_name(const Side& side) {
+
+    std::string name = "K";
+    for (PieceType pt : side)
+        name += PieceToChar[pt];
+    return name;
+}
+
+Value side_value(const Side& side) {
+
+    Value v = VALUE_ZERO;
+    for (PieceType pt : side)
+        v += PieceValue[pt];
+    return v;
+}
+
+// Orders the two sides of a signature as in the file names: the stronger first
+bool is_canonical(const Side& white, const Side& black) {
+
+    Value w = side_value(white), b = side_value(black);
+    return w != b ? w > b : side_name(white) >= side_name(black);
+}
+
+// Parses one side of a signature such as "KRC". Returns false if it is invalid.
+bool parse_side(const std::string& s, Side& side) {
+
+    if (s.empty() || s[0] != 'K')
+        return false;
+
+    int count[PIECE_TYPE_NB] = {};
+
+    for (char ch : s.substr(1))
+    {
+        size_t pt = PieceToChar.find(char(toupper(ch)));
+        if (pt == std::string_view::npos || pt == KING || pt == NO_PIECE_TYPE
+            || ++count[pt] > (pt == PAWN ? 5 : 2))
+            return false;
+    }
+
+    side.clear();
+    for (PieceType pt : SignatureOrder)
+        side.insert(side.end(), count[pt], pt);
+
+    return true;
+}
+
+uint64_t material_code(const Side& white, const Side& black) {
+
+    uint64_t code = 0;
+    for (PieceType pt : white)
+        code += uint64_t(1) << (3 * make_piece(WHITE, pt));
+    for (PieceType pt : black)
+        code += uint64_t(1) << (3 * make_piece(BLACK, pt));
+    return code;
+}
+
+uint64_t material_code(const Position& pos) {
+
+    uint64_t code = 0;
+    for (Color c : {WHITE, BLACK})
+        for (PieceType pt : SignatureOrder)
+            code += uint64_t(popcount(pos.pieces(c, pt))) << (3 * make_piece(c, pt));
+    return code;
+}
+
+std::unique_ptr<Table> make_table(const Side& white, const Side& black) {
+
+    auto t        = std::make_unique<Table>();
+    t->name       = side_name(white) + "v" + side_name(black);
+    t->code       = material_code(white, black);
+    t->pieceCount = 0;
+    t->size       = COLOR_NB;
+    t->maxDTM     = 0;
+
+    t->pieces[t->pieceCount++] = W_KING;
+    t->pieces[t->pieceCount++] = B_KING;
+    for (PieceType pt : white)
+        t->pieces[t->pieceCount++] = make_piece(WHITE, pt);
+    for (PieceType pt : black)
+        t->pieces[t->pieceCount++] = make_piece(BLACK, pt);
+
+    for (int i = 0; i < t->pieceCount; ++i)
+        t->size *= Domains[t->pieces[i]].size;
+
+    return t;
+}
+
+void register_table(std::unique_ptr<Table> t, const Side& white, const Side& black) {
+
+    Lookup[material_code(white, black)] = {t.get(), false};
+    Lookup[material_code(black, white)] = {t.get(), true};
+
+    MaxCardinality = std::max(MaxCardinality, t->pieceCount);
+    Tables.push_back(std::move(t));
+}
+
+bool load_table(const std::string& directory, const Side& white, const Side& black) {
+
+    auto        t = make_table(white, black);
+    std::string file =
+      (directory.empty() ? std::string(".") : directory) + "/" + t->name + ".ptb";
+
+    t->mapping = map_file(file, t->mappedSize);
+    if (!t->mapping)
+        return false;
+
+    Header h;
+    std::memcpy(&h, t->mapping, sizeof(Header));
+
+    if (h.magic != Magic || h.version != Version || h.size != t->size
+        || t->mappedSize != sizeof(Header) + t->size || t->name.compare(0, 12, h.name) != 0)
+    {
+        sync_cout << "info string " << file << " is not a valid table" << sync_endl;
+        return false;
+    }
+
+    t->data   = static_cast<const uint8_t*>(t->mapping) + sizeof(Header);
+    t->maxDTM = int(h.maxDTM);
+    register_table(std::move(t), white, black);
+    return true;
+}
+
+// Calls f for every side with up to 'n' pieces besides the king, in signature
+// order and within the piece limits.
+template<typename F>
+void for_each_side(int n, const F& f, Side& side, size_t first = 0) {
+
+    f(side);
+
+    if (int(side.size()) == n)
+        return;
+
+    for (size_t i = first; i < std::size(SignatureOrder); ++i)
+    {
+        PieceType pt = SignatureOrder[i];
+        if (std::count(side.begin(), side.end(), pt) == (pt == PAWN ? 5 : 2))
+            continue;
+
+        side.push_back(pt);
+        for_each_side(n, f, side, i);
+        side.pop_back();
+    }
+}
+
+
+// Returns the index of the position in the table. The colors of the position
+// are swapped, and its ranks flipped, when the table has the material of black
+// first. Its files are mirrored to bring the white king to the files D or E.
+template<typename Pos>
+uint64_t encode(const Table& t, bool flip, const Pos& pos) {
+
+    const Color white  = flip ? BLACK : WHITE;
+    Square      wksq   = pos.king_square(white);
+    const bool  mirror = file_of(wksq) > FILE_E;
+
+    uint64_t idx = uint64_t(flip ? ~pos.side_to_move() : pos.side_to_move());
+    Bitboard b   = 0;
+
+    for (int i = 0; i < t.pieceCount; ++i)
+    {
+        const Piece pc = t.pieces[i];
+
+        // Pieces of the same kind take their squares in order. The index does
+        // not sort them, so that a placement of k identical pieces has k! indices,
+        // which keeps it a plain product of the domains at the cost of space.
+        if (i == 0 || pc != t.pieces[i - 1])
+            b = pos.pieces(flip ? ~color_of(pc) : color_of(pc), type_of(pc));
+
+        Square s = pop_lsb(b);
+        if (flip)
+            s = flip_rank(s);
+        if (mirror)
+            s = flip_file(s);
+
+        const Domain& d = Domains[pc];
+        assert(d.square[d.index[s]] == s);
+
+        idx = idx * d.size + d.index[s];
+    }
+
+    return idx;
+}
+
+std::pair<const Table*, bool> find_table(const Position& pos) {
+
+    auto it = Lookup.find(material_code(pos));
+    return it != Lookup.end() ? it->second : std::pair<const Table*, bool>(nullptr, false);
+}
+
+// Returns the distance to mate of the position in plies, odd when the side to
+// move wins, or Drawn, or NotFound.
+int probe_dtm(const Position& pos) {
+
+    auto [t, flip] = find_table(pos);
+    if (!t)
+        return NotFound;
+
+    const uint8_t v = t->data[encode(*t, flip, pos)];
+    return v == 0 ? Drawn : v == DTMUnknown ? NotFound : v - 1;
+}
+
+
+// A lightweight board used by the generator, which decodes and plays through
+// far more positions than search and has no use for the state kept by Position.
+struct Board {
+    Bitboard pieces(Color c, PieceType pt) const { return byColorBB[c] & byTypeBB[pt]; }
+    Square   king_square(Color c) const { return kingSquare[c]; }
+    Color    side_to_move() const { return sideToMove; }
+
+    void put_piece(Piece pc, Square s) {
+        board[s] = pc;
+        byColorBB[color_of(pc)] |= s;
+        byTypeBB[type_of(pc)] |= s;
+        if (type_of(pc) == KING)
+            kingSquare[color_of(pc)] = s;
+    }
+
+    // Plays a move and returns the captured piece
+    Piece do_move(Square from, Square to) {
+        const Piece pc = board[from], captured = board[to];
+
+        if (captured)
+        {
+            byColorBB[color_of(captured)] ^= to;
+            byTypeBB[type_of(captured)] ^= to;
+        }
+
+        board[from] = NO_PIECE;
+        byColorBB[color_of(pc)] ^= from;
+        byTypeBB[type_of(pc)] ^= from;
+        put_piece(pc, to);
+
+        sideToMove = ~sideToMove;
+        return captured;
+    }
+
+    // Tests whether the king of the given color is attacked, by the other king
+    // too when they face each other.
+    bool attacked(Color c) const {
+        const Square   ksq      = kingSquare[c];
+        const Bitboard occupied = byColorBB[WHITE] | byColorBB[BLACK];
+
+        return ((pawn_attacks_to_bb(~c, ksq) & byTypeBB[PAWN])
+                | (attacks_bb<KNIGHT_TO>(ksq, occupied) & byTypeBB[KNIGHT])
+                | (attacks_bb<ROOK>(ksq, occupied) & (byTypeBB[KING] | byTypeBB[ROOK]))
+                | (attacks_bb<CANNON>(ksq, occupied) & byTypeBB[CANNON]))
+             & byColorBB[~c];
+    }
+
+    Piece    board[SQUARE_NB];
+    Bitboard byColorBB[COLOR_NB];
+    Bitboard byTypeBB[PIECE_TYPE_NB];
+    Square   kingSquare[COLOR_NB];
+    Color    sideToMove;
+};
+
+// Sets up the board of a table index. Returns false if the position is illegal.
+bool decode(const Table& t, uint64_t idx, Board& b) {
+
+    Square sq[MaxPieces];
+
+    for (int i = t.pieceCount - 1; i >= 0; --i)
+    {
+        const Domain& d = Domains[t.pieces[i]];
+        sq[i]           = d.square[idx % d.size];
+        idx /= d.size;
+    }
+
+    std::memset(&b, 0, sizeof(Board));
+    b.sideToMove = Color(idx);
+
+    for (int i = 0; i < t.pieceCount; ++i)
+    {
+        if (b.board[sq[i]])
+            return false;
+        b.put_piece(t.pieces[i], sq[i]);
+    }
+
+    // The side which just moved cannot have left its king in check
+    return !b.attacked(~b.sideToMove);
+}
+
+// Calls f with the board after each legal move and the captured piece, until
+// f returns false.
+template<typename F>
+void for_each_legal_move(const Board& b, const F& f) {
+
+    const Color    us       = b.sideToMove;
+    const Bitboard occupied = b.byColorBB[WHITE] | b.byColorBB[BLACK];
+
+    for (Bitboard pieces = b.byColorBB[us]; pieces;)
+    {
+        const Square    from = pop_lsb(pieces);
+        const PieceType pt   = type_of(b.board[from]);
+
+        Bitboard targets = pt == PAWN ? pawn_attacks_bb(us, from)
+                         : pt == CANNON
+                           ? (attacks_bb<CANNON>(from, occupied) & b.byColorBB[~us])
+                               | (attacks_bb<ROOK>(from, occupied) & ~occupied)
+                           : attacks_bb(pt, from, occupied);
+
+        targets &= ~b.byColorBB[us];
+
+        while (targets)
+        {
+            Board       child    = b;
+            const Piece captured = child.do_move(from, pop_lsb(targets));
+
+            if (!child.attacked(us) && !f(child, captured))
+                return;
+        }
+    }
+}
+
+// Runs f on every index of the table with the given number of threads, and
+// returns the sum of its results.
+template<typename F>
+uint64_t parallel_for(uint64_t size, size_t threads, const F& f) {
+
+    std::atomic<uint64_t>    next{0}, total{0};
+    std::vector<std::thread> workers;
+
+    for (size_t i = 0; i < std::max(threads, size_t(1)); ++i)
+        workers.emplace_back([&]() {
+            uint64_t sum = 0;
+
+            for (uint64_t begin; (begin = next.fetch_add(GenerateStep)) < size;)
+                for (uint64_t idx = begin; idx < std::min(begin + GenerateStep, size); ++idx)
+                    sum += f(idx);
+
+            total += sum;
+        });
+
+    for (auto& w : workers)
+        w.join();
+
+    return total;
+}
+
+// Builds the table by forward iteration, the tables reached by captures being
+// available. Each pass decodes the unresolved positions and looks up the results
+// of all their moves: pass n finds the positions mated in n plies, or for odd n
+// the positions mating in n plies. Positions left unresolved are draws. Perpetual
+// check and chase rules are not applied within the table.
+std::unique_ptr<Table> build_table(const Side& white, const Side& black, size_t threads) {
+
+    auto        t     = make_table(white, black);
+    const auto  start = now();
+    const auto  size  = t->size;
+    std::unique_ptr<std::atomic<uint16_t>[]> work(new std::atomic<uint16_t>[size]);
+
+    // Mates reached through a capture can be longer than those within the table
+    int maxSubDTM = 0;
+    for (int i = 2; i < t->pieceCount; ++i)
+        maxSubDTM = std::max(
+          maxSubDTM, Lookup.at(t->code - (uint64_t(1) << (3 * t->pieces[i]))).first->maxDTM);
+
+    // Distance to mate of a position after a move, or Drawn if it is not known
+    auto child_dtm = [&](const Board& child, Piece captured) {
+        if (!captured)
+        {
+            const uint16_t w = work[encode(*t, false, child)].load(std::memory_order_relaxed);
+            return w && w != Illegal ? w - 1 : Drawn;
+        }
+
+        auto [sub, flip] = Lookup.at(t->code - (uint64_t(1) << (3 * captured)));
+        const uint8_t v  = sub->data[encode(*sub, flip, child)];
+        return v && v != DTMUnknown ? v - 1 : Drawn;
+    };
+
+    // Positions without legal moves are lost in xiangqi, stalemate included
+    uint64_t legal = size - parallel_for(size, threads, [&](uint64_t idx) {
+                         Board b;
+                         if (!decode(*t, idx, b))
+                         {
+                             work[idx] = Illegal;
+                             return 1;
+                         }
+
+                         bool hasMoves = false;
+                         for_each_legal_move(b, [&](const Board&, Piece) {
+                             hasMoves = true;
+                             return false;
+                         });
+
+                         work[idx] = hasMoves ? 0 : 1;
+                         return 0;
+                     });
+
+    int lastChange = 0;
+
+    for (int n = 1; n < Illegal - 1; ++n)
+    {
+        const bool wins = n % 2;
+
+        uint64_t changes = parallel_for(size, threads, [&](uint64_t idx) {
+            if (work[idx].load(std::memory_order_relaxed))
+                return 0;
+
+            Board b;
+            decode(*t, idx, b);
+
+            // Won if some move mates in n - 1 plies, lost if every move leads to a
+            // position won in less than n plies.
+            bool resolved = !wins;
+            for_each_legal_move(b, [&](const Board& child, Piece captured) {
+                const int d = child_dtm(child, captured);
+                if (wins ? d == n - 1 : d < 0 || d % 2 == 0 || d >= n)
+                {
+                    resolved = wins;
+                    return false;
+                }
+                return true;
+            });
+
+            if (!resolved)
+                return 0;
+
+            work[idx].store(uint16_t(n + 1), std::memory_order_relaxed);
+            return 1;
+        });
+
+        if (changes)
+            lastChange = n;
+
+        std::cerr << "\r" << t->name << ": " << n << " plies" << std::flush;
+
+        if (n > lastChange + 1 && n > maxSubDTM + 1)
+            break;
+    }
+
+    t->memory.resize(size);
+    uint64_t results[3] = {};  // Losses, draws and wins for the side to move
+
+    for (uint64_t idx = 0; idx < size; ++idx)
+    {
+        const uint16_t w = work[idx];
+
+        if (w == Illegal || w == 0)
+        {
+            t->memory[idx] = 0;
+            results[1] += w == 0;
+            continue;
+        }
+
+        t->memory[idx] = uint8_t(std::min(int(w), int(DTMUnknown)));
+        t->maxDTM      = std::max(t->maxDTM, std::min(w - 1, DTMUnknown - 2));
+        results[(w - 1) % 2 ? 2 : 0]++;
+    }
+
+    t->data = t->memory.data();
+
+    std::cerr << "\r" << t->name << ": " << legal << " positions, " << results[2] << " won, "
+              << results[1] << " drawn, " << results[0] << " lost, longest mate " << t->maxDTM
+              << " plies, " << now() - start << " ms" << std::endl;
+
+    return t;
+}
+
+bool write_table(const Table& t, const std::string& file) {
+
+    Header h{};
+    h.magic   = Magic;
+    h.version = Version;
+    h.size    = t.size;
+    h.maxDTM  = uint32_t(t.maxDTM);
+    std::strncpy(h.name, t.name.c_str(), sizeof(h.name));
+
+    std::ofstream out(file, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(t.data), std::streamsize(t.size));
+    return bool(out);
+}
+
+// Builds the table of the given sides, after the smaller tables it depends on,
+// unless it is already available.
+void generate_recursive(const Side& white,
+                        const Side& black,
+                        const std::string& directory,
+                        size_t             threads,
+                        std::vector<std::string>& written) {
+
+    if (Lookup.count(material_code(white, black)))
+        return;
+
+    for (int c = 0; c < 2; ++c)
+        for (size_t i = 0; i < (c ? black : white).size(); ++i)
+        {
+            Side w = white, b = black;
+            Side& side = c ? b : w;
+            side.erase(side.begin() + i);
+
+            if (is_canonical(w, b))
+                generate_recursive(w, b, directory, threads, written);
+            else
+                generate_recursive(b, w, directory, threads, written);
+        }
+
+    auto        t    = build_table(white, black, threads);
+    std::string file = directory + "/" + t->name + ".ptb";
+
+    if (write_table(*t, file))
+        written.push_back(file);
+    else
+        sync_cout << "info string Could not write " << file << sync_endl;
+
+    register_table(std::move(t), white, black);
+}
+
+}  // namespace
+
+
+std::string init(const std::string& paths) {
+
+    init_domains();
+
+    Tables.clear();
+    Lookup.clear();
+    MaxCardinality = 0;
+
+    if (paths.empty() || paths == "<empty>")
+        return "No tablebases";
+
+    std::vector<std::string> directories;
+    std::stringstream        ss(paths);
+    for (std::string dir; std::getline(ss, dir, PathSeparator);)
+        directories.push_back(dir);
+
+    // Try every signature up to the size of the tables the generator builds
+    Side white, black;
+    for_each_side(MaxPieces - 2, [&](const Side& w) {
+        for_each_side(MaxPieces - 2 - int(w.size()), [&](const Side& b) {
+            if (!is_canonical(w, b) || Lookup.count(material_code(w, b)))
+                return;
+
+            for (const auto& dir : directories)
+                if (load_table(dir, w, b))
+                    break;
+        }, black);
+    }, white);
+
+    return "Found " + std::to_string(Tables.size()) + " tablebases";
+}
+
+
+Value probe(const Position& pos, int ply) {
+
+    const int dtm = probe_dtm(pos);
+
+    // A draw of the tables may be a win under the perpetual check and chase
+    // rules, which they ignore, so only mates are trusted.
+    if (dtm == NotFound || dtm == Drawn)
+        return VALUE_NONE;
+
+    // A longer mate could be prevented by the rule 60, or be out of the range
+    // of mate scores.
+    if (pos.rule60_count() + dtm >= 120 || ply + dtm >= MAX_PLY)
+        return VALUE_NONE;
+
+    return dtm % 2 ? mate_in(ply + dtm) : mated_in(ply + dtm);
+}
+
+
+Config rank_root_moves(const OptionsMap& options, Position& pos, Search::RootMoves& rootMoves) {
+
+    Config config;
+
+    if (rootMoves.empty())
+        return config;
+
+    config.cardinality = MaxCardinality;
+    config.probeDepth  = int(options["TablebaseProbeDepth"]);
+
+    const Value rootValue =
+      pos.count<ALL_PIECES>() > config.cardinality ? VALUE_NONE : probe(pos, 0);
+
+    if (rootValue == VALUE_NONE)
+        return config;
+
+    StateInfo          st;
+    std::vector<Value> values;
+
+    for (const auto& rm : rootMoves)
+    {
+        pos.do_move(rm.pv[0], st);
+        const Value v = probe(pos, 1);
+        pos.undo_move(rm.pv[0]);
+
+        // When losing, a move the tables cannot tell about may be the best defence.
+        // When winning, it is not the shortest mate and is dropped.
+        if (v == VALUE_NONE && rootValue < VALUE_DRAW)
+            return config;
+
+        values.push_back(v == VALUE_NONE ? -VALUE_INFINITE : -v);
+    }
+
+    // Keep the moves with the best result, the shortest mate when winning
+    const Value best = *std::max_element(values.begin(), values.end());
+    size_t      n    = 0;
+
+    for (size_t i = 0; i < rootMoves.size(); ++i)
+        if (values[i] == best)
+            rootMoves[n++] = rootMoves[i];
+
+    rootMoves.erase(rootMoves.begin() + n, rootMoves.end());
+
+    return config;
+}
+
+
+void generate(const std::string& signature, const std::string& directory, size_t threads) {
+
+    init_domains();
+
+    const size_t v = signature.find('v');
+    Side         white, black;
+
+    if (v == std::string::npos || !parse_side(signature.substr(0, v), white)
+        || !parse_side(signature.substr(v + 1), black)
+        || int(white.size() + black.size()) + 2 > MaxPieces)
+    {
+        sync_cout << "info string Invalid signature " << signature << ", expected e.g. KRvKAA with"
+                  << " at most " << MaxPieces << " pieces" << sync_endl;
+        return;
+    }
+
+    if (!is_canonical(white, black))
+        std::swap(white, black);
+
+    if (Lookup.count(material_code(white, black)))
+    {
+        sync_cout << "info string " << side_name(white) << "v" << side_name(black)
+                  << " is already available" << sync_endl;
+        return;
+    }
+
+    // The tables it depends on are smaller, and building one takes 3 bytes a position
+    if (make_table(white, black)->size > MaxGenerateSize)
+    {
+        sync_cout << "info string " << side_name(white) << "v" << side_name(black)
+                  << " is too large to be generated" << sync_endl;
+        return;
+    }
+
+    const auto               start = now();
+    std::vector<std::string> written;
+
+    generate_recursive(white, black, directory.empty() ? "." : directory, threads, written);
+
+    std::cerr << "==========================="
+              << "\nTables written     : " << written.size()
+              << "\nTotal time (ms)    : " << now() - start << std::endl;
+
+    for (const auto& file : written)
+        std::cerr << file << std::endl;
+}
+
+}  // namespace Stockfish::Tablebases
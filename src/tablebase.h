@@ -0,0 +1,73 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2025 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TABLEBASE_H_INCLUDED
+#define TABLEBASE_H_INCLUDED
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "types.h"
+
+namespace Stockfish {
+
+class Position;
+class OptionsMap;
+
+namespace Search {
+struct RootMove;
+using RootMoves = std::vector<RootMove>;
+}
+
+// Endgame tablebases of small material signatures, built by forward iteration
+// with the 'tbgen' command. A table stores for every position the
+// distance to mate in plies with best play, ignoring the rule 60 and the
+// repetition rules, in one byte.
+namespace Tablebases {
+
+struct Config {
+    int   cardinality = 0;
+    Depth probeDepth  = 0;
+};
+
+// Largest number of pieces, kings included, of the tables found
+extern int MaxCardinality;
+
+// Loads the tables found in the given directories, separated by ':' (';' on
+// Windows), and returns a description of what was found.
+std::string init(const std::string& paths);
+
+// Returns the mate score of the position from the tables, counted from ply
+// plies below the root, or VALUE_NONE if the tables cannot tell it. Draws of
+// the tables give VALUE_NONE too, since they ignore the perpetual rules.
+Value probe(const Position& pos, int ply);
+
+// Keeps only the root moves with the best result according to the tables.
+Config rank_root_moves(const OptionsMap& options, Position& pos, Search::RootMoves& rootMoves);
+
+// Builds the table of the given material signature, e.g. "KRvKAA", and the
+// smaller ones it depends on that are not loaded yet, and writes them to the
+// given directory.
+void generate(const std::string& signature, const std::string& directory, size_t threads);
+
+}  // namespace Tablebases
+
+}  // namespace Stockfish
+
+#endif  // #ifndef TABLEBASE_H_INCLUDED
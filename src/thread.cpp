@@ -23,11 +23,11 @@
 #include <deque>
 #include <memory>
 #include <string>
-#include <unordered_map>
 #include <utility>
 
 #include "movegen.h"
 #include "search.h"
+#include "tablebase.h"
 #include "timeman.h"
 #include "types.h"
 #include "uci.h"
@@ -40,20 +40,27 @@ namespace Stockfish {
 Thread::Thread(Search::SharedState&                    sharedState,
                std::unique_ptr<Search::ISearchManager> sm,
                size_t                                  n,
-               OptionalThreadToNumaNodeBinder          binder) :
+               OptionalThreadToNumaNodeBinder          binder,
+               LargePagePtr<HistoryTables>&            histories) :
     idx(n),
     nthreads(sharedState.options["Threads"]),
     stdThread(&Thread::idle_loop, this) {
 
     wait_for_search_finished();
 
-    run_custom_job([this, &binder, &sharedState, &sm, n]() {
+    run_custom_job([this, &binder, &sharedState, &sm, &histories, n]() {
         // Use the binder to [maybe] bind the threads to a NUMA node before doing
         // the Worker allocation. Ideally we would also allocate the SearchManager
-        // here, but that's minor.
+        // here, but that's minor. The first thread using the history tables
+        // allocates them, and clears them so that they are first touched locally.
         this->numaAccessToken = binder();
-        this->worker =
-          std::make_unique<Search::Worker>(sharedState, std::move(sm), n, this->numaAccessToken);
+
+        const bool first = !histories;
+        if (first)
+            histories = make_unique_large_page<HistoryTables>();
+
+        this->worker = std::make_unique<Search::Worker>(sharedState, std::move(sm), n,
+                                                        this->numaAccessToken, *histories, first);
     });
 
     wait_for_search_finished();
@@ -90,6 +97,13 @@ void Thread::wait_for_search_finished() {
     cv.wait(lk, [&] { return !searching; });
 }
 
+// Returns whether the thread is parked in idle_loop(), without blocking
+bool Thread::is_idle() {
+
+    std::lock_guard<std::mutex> lk(mutex);
+    return !searching;
+}
+
 // Launching a function in the thread
 void Thread::run_custom_job(std::function<void()> f) {
     {
@@ -130,6 +144,7 @@ void Thread::idle_loop() {
 Search::SearchManager* ThreadPool::main_manager() { return main_thread()->worker->main_manager(); }
 
 uint64_t ThreadPool::nodes_searched() const { return accumulate(&Search::Worker::nodes); }
+uint64_t ThreadPool::tb_hits() const { return accumulate(&Search::Worker::tbHits); }
 
 // Creates/destroys threads to match the requested number.
 // Created and launched threads will immediately go to sleep in idle_loop.
@@ -143,6 +158,7 @@ void ThreadPool::set(const NumaConfig&                           numaConfig,
         main_thread()->wait_for_search_finished();
 
         threads.clear();
+        historyTables.clear();
 
         boundThreadToNumaNode.clear();
     }
@@ -173,6 +189,13 @@ void ThreadPool::set(const NumaConfig&                           numaConfig,
                                 ? numaConfig.distribute_threads_among_numa_nodes(requested)
                                 : std::vector<NumaIndex>{};
 
+        // With shared histories, the threads of a NUMA node, or all of them when
+        // they are not bound, use the same tables.
+        const bool sharedHistory = sharedState.options["SharedHistory"];
+        historyTables.resize(!sharedHistory ? requested
+                             : doBindThreads ? numaConfig.num_numa_nodes()
+                                             : 1);
+
         while (threads.size() < requested)
         {
             const size_t    threadId = threads.size();
@@ -188,8 +211,9 @@ void ThreadPool::set(const NumaConfig&                           numaConfig,
             auto binder = doBindThreads ? OptionalThreadToNumaNodeBinder(numaConfig, numaId)
                                         : OptionalThreadToNumaNodeBinder(numaId);
 
-            threads.emplace_back(
-              std::make_unique<Thread>(sharedState, std::move(manager), threadId, binder));
+            threads.emplace_back(std::make_unique<Thread>(
+              sharedState, std::move(manager), threadId, binder,
+              historyTables[!sharedHistory ? threadId : numaId]));
         }
 
         clear();
@@ -243,8 +267,11 @@ void ThreadPool::start_thinking(Position& pos, StateListPtr& states, Search::Lim
 
     increaseDepth = true;
 
-    Search::RootMoves rootMoves;
-    const auto        legalmoves = MoveList<LEGAL>(pos);
+    const auto legalmoves = MoveList<LEGAL>(pos);
+
+    // Built once per search in storage kept across searches, the workers copy
+    // it into their own root moves, which also keep their capacity.
+    rootMoves.clear();
 
     for (const auto& uciMove : limits.searchmoves)
     {
@@ -258,6 +285,22 @@ void ThreadPool::start_thinking(Position& pos, StateListPtr& states, Search::Lim
         for (const auto& m : legalmoves)
             rootMoves.emplace_back(m);
 
+    Tablebases::Config tbConfig =
+      Tablebases::rank_root_moves(main_thread()->worker->options, pos, rootMoves);
+    int ttProbeAhead = int(main_thread()->worker->options["TTProbeAhead"]);
+
+    for (size_t i = 0; i < rootMoves.size(); ++i)
+    {
+        rootMoves[i].statsIdx = i;
+
+        rootMoveStats[i].depth = 0;
+        rootMoveStats[i].owner = -1;
+
+        rootMoveStats[i].voteScore = rootMoveStats[i].voteDepth = 0;
+    }
+
+    rootNodes = duplicateRootNodes = 0;
+
     // After ownership transfer 'states' becomes empty, so if we stop the search
     // and call 'go' again without setting a new position states.get() == nullptr.
     assert(states.get() || setupStates.get());
@@ -274,9 +317,13 @@ void ThreadPool::start_thinking(Position& pos, StateListPtr& states, Search::Lim
     {
         th->run_custom_job([&]() {
             th->worker->limits = limits;
-            th->worker->nodes = th->worker->nmpMinPly = th->worker->bestMoveChanges = 0;
+            th->worker->nodes = th->worker->tbHits = th->worker->nmpMinPly =
+              th->worker->bestMoveChanges         = 0;
             th->worker->rootDepth = th->worker->completedDepth = 0;
+            th->worker->voteIdx = th->worker->voteScore = th->worker->voteDepth = 0;
             th->worker->rootMoves                              = rootMoves;
+            th->worker->tbConfig                               = tbConfig;
+            th->worker->ttProbeAhead                           = ttProbeAhead;
             th->worker->rootPos.set(pos, &th->worker->rootState);
             th->worker->rootState = setupStates->back();
         });
@@ -288,14 +335,22 @@ void ThreadPool::start_thinking(Position& pos, StateListPtr& states, Search::Lim
     main_thread()->start_searching();
 }
 
+// Hands the setup states of the last search back to the caller, so that a
+// position extending the previous one can be continued in place. Returns an
+// empty pointer if a search may still be reading them.
+StateListPtr ThreadPool::reclaim_setup_states() {
+
+    if (!main_thread()->is_idle())
+        return StateListPtr();
+
+    return std::move(setupStates);
+}
+
 Thread* ThreadPool::get_best_thread() const {
 
     Thread* bestThread = threads.front().get();
     Value   minScore   = VALUE_NONE;
 
-    std::unordered_map<Move, int64_t, Move::MoveHash> votes(
-      2 * std::min(size(), bestThread->worker->rootMoves.size()));
-
     // Find the minimum score of all threads
     for (auto&& th : threads)
         minScore = std::min(minScore, th->worker->rootMoves[0].score);
@@ -305,8 +360,13 @@ Thread* ThreadPool::get_best_thread() const {
         return (th->worker->rootMoves[0].score - minScore + 14) * int(th->worker->completedDepth);
     };
 
-    for (auto&& th : threads)
-        votes[th->worker->rootMoves[0].pv[0]] += thread_voting_value(th.get());
+    // The threads have tallied their votes per root move while searching, see
+    // Search::Worker::publish_vote(), so only the minimum score is applied here.
+    auto votes = [&](const Search::RootMove& rm) {
+        const Search::RootMoveStats& stats = rootMoveStats[rm.statsIdx];
+        return stats.voteScore.load(std::memory_order_relaxed)
+             + (14 - minScore) * stats.voteDepth.load(std::memory_order_relaxed);
+    };
 
     for (auto&& th : threads)
     {
@@ -316,8 +376,8 @@ Thread* ThreadPool::get_best_thread() const {
         const auto& bestThreadPV = bestThread->worker->rootMoves[0].pv;
         const auto& newThreadPV  = th->worker->rootMoves[0].pv;
 
-        const auto bestThreadMoveVote = votes[bestThreadPV[0]];
-        const auto newThreadMoveVote  = votes[newThreadPV[0]];
+        const auto bestThreadMoveVote = votes(bestThread->worker->rootMoves[0]);
+        const auto newThreadMoveVote  = votes(th->worker->rootMoves[0]);
 
         const bool bestThreadInProvenWin = is_win(bestThreadScore);
         const bool newThreadInProvenWin  = is_win(newThreadScore);
@@ -28,6 +28,7 @@
 #include <mutex>
 #include <vector>
 
+#include "memory.h"
 #include "numa.h"
 #include "position.h"
 #include "search.h"
@@ -73,7 +74,8 @@ class Thread {
     Thread(Search::SharedState&,
            std::unique_ptr<Search::ISearchManager>,
            size_t,
-           OptionalThreadToNumaNodeBinder);
+           OptionalThreadToNumaNodeBinder,
+           LargePagePtr<HistoryTables>&);
     virtual ~Thread();
 
     void idle_loop();
@@ -89,6 +91,7 @@ class Thread {
     // appropriate specificity regarding search, from the point of view of an
     // outside user, so renaming of this function is left for whenever that happens.
     void   wait_for_search_finished();
+    bool   is_idle();
     size_t id() const { return idx; }
 
     std::unique_ptr<Search::Worker> worker;
@@ -139,9 +142,11 @@ class ThreadPool {
     Search::SearchManager* main_manager();
     Thread*                main_thread() const { return threads.front().get(); }
     uint64_t               nodes_searched() const;
+    uint64_t               tb_hits() const;
     Thread*                get_best_thread() const;
     void                   start_searching();
     void                   wait_for_search_finished() const;
+    StateListPtr           reclaim_setup_states();
 
     std::vector<size_t> get_bound_thread_count_by_numa_node() const;
 
@@ -149,6 +154,11 @@ class ThreadPool {
 
     std::atomic_bool stop, abortedSearch, increaseDepth;
 
+    // Shared statistics of the root moves of the current search, and the root
+    // nodes searched in total and again at a depth already completed elsewhere.
+    Search::RootMoveStats rootMoveStats[MAX_MOVES];
+    std::atomic<uint64_t> rootNodes, duplicateRootNodes;
+
     auto cbegin() const noexcept { return threads.cbegin(); }
     auto begin() noexcept { return threads.begin(); }
     auto end() noexcept { return threads.end(); }
@@ -156,10 +166,17 @@ class ThreadPool {
     auto size() const noexcept { return threads.size(); }
     auto empty() const noexcept { return threads.empty(); }
 
+    size_t history_tables_count() const { return historyTables.size(); }
+
    private:
     StateListPtr                         setupStates;
-    std::vector<std::unique_ptr<Thread>> threads;
-    std::vector<NumaIndex>               boundThreadToNumaNode;
+    Search::RootMoves                    rootMoves;  // Copied by every worker on each search
+
+    // History tables of each thread, or of each NUMA node when they are shared,
+    // declared before the threads using them to outlive them
+    std::vector<LargePagePtr<HistoryTables>> historyTables;
+    std::vector<std::unique_ptr<Thread>>     threads;
+    std::vector<NumaIndex>                   boundThreadToNumaNode;
 
     uint64_t accumulate(std::atomic<uint64_t> Search::Worker::* member) const {
 
@@ -0,0 +1,534 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2025 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "trainingdata.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "misc.h"
+#include "movegen.h"
+#include "position.h"
+#include "search.h"
+#include "thread.h"
+#include "tt.h"
+#include "ucioption.h"
+
+namespace Stockfish::TrainingData {
+
+namespace {
+
+constexpr auto StartFEN = "rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR w";
+
+// Number of entries collected before they are written out in one block
+constexpr size_t WriteBufferEntries = 1 << 16;
+
+// Number of entries read, rescored and written at a time by 'rescore', and the
+// number of consecutive entries handed out to a thread at once.
+constexpr size_t RescoreBatchEntries = 1 << 20;
+constexpr size_t RescoreChunkEntries = 256;
+
+// Collects the entries of finished games and writes them sequentially to the
+// output file in large blocks, so that many games can share one stream.
+class EntryWriter {
+   public:
+    explicit EntryWriter(const std::string& fileName) :
+        file(fileName, std::ios::binary | std::ios::app) {
+        buffer.reserve(WriteBufferEntries);
+    }
+
+    ~EntryWriter() { flush(); }
+
+    bool is_open() const { return file.is_open(); }
+
+    void write(const std::vector<PackedEntry>& entries) {
+        std::lock_guard<std::mutex> lk(mutex);
+
+        buffer.insert(buffer.end(), entries.begin(), entries.end());
+        written += entries.size();
+
+        if (buffer.size() >= WriteBufferEntries)
+            flush_buffer();
+    }
+
+    void flush() {
+        std::lock_guard<std::mutex> lk(mutex);
+        flush_buffer();
+        file.flush();
+    }
+
+    uint64_t count() const { return written; }
+
+   private:
+    void flush_buffer() {
+        file.write(reinterpret_cast<const char*>(buffer.data()),
+                   std::streamsize(buffer.size() * sizeof(PackedEntry)));
+        buffer.clear();
+    }
+
+    std::ofstream            file;
+    std::vector<PackedEntry> buffer;
+    std::mutex               mutex;
+    std::atomic<uint64_t>    written = 0;
+};
+
+// A single-threaded searcher with its own thread pool, hash table and options,
+// so that several of them can search different positions at the same time.
+// Only the network is shared. The hash and histories are kept between searches
+// until clear() is called.
+class Searcher {
+   public:
+    Searcher(const OptionsMap&                              engineOptions,
+             const LazyNumaReplicated<Eval::NNUE::Network>& network,
+             size_t                                         hashMB,
+             Depth                                          depth,
+             uint64_t                                       nodes) {
+
+        // All the options of the engine, so that none the search reads is
+        // missing, with the settings of a lone single-threaded search
+        options.add_copies(engineOptions);
+
+        for (const char* setting :
+             {"Threads value 1", "NumaPolicy value none", "MultiPV value 1",
+              "UCI_ShowWDL value false", "Ponder value false", "Move Overhead value 0",
+              "nodestime value 0", "SharedHistory value false"})
+        {
+            std::istringstream is(std::string("name ") + setting);
+            options.setoption(is);
+        }
+
+        updateContext.onUpdateNoMoves = [](const Search::InfoShort&) {};
+        updateContext.onUpdateFull    = [](const Search::InfoFull&) {};
+        updateContext.onIter          = [](const Search::InfoIteration&) {};
+        updateContext.onBestmove      = [](std::string_view, std::string_view) {};
+
+        threads.set(NumaConfig{}, {options, threads, tt, network, cluster}, updateContext);
+        tt.resize(hashMB, threads);
+
+        limits.depth = depth;
+        limits.nodes = nodes;
+    }
+
+    void clear() {
+        threads.clear();
+        tt.clear(threads);
+    }
+
+    // Searches the position, which must have legal moves, and returns the best
+    // move with its score from the point of view of the side to move.
+    std::pair<Move, Value> search(Position& pos, StateListPtr& states) {
+
+        limits.startTime = now();
+        threads.start_thinking(pos, states, limits);
+        threads.main_thread()->wait_for_search_finished();
+        states = threads.reclaim_setup_states();
+
+        const Search::RootMove& rm = threads.main_thread()->worker->best_root_move();
+
+        Value v = rm.score != -VALUE_INFINITE ? rm.uciScore : rm.previousScore;
+        if (v == -VALUE_INFINITE)
+            v = VALUE_ZERO;
+
+        return {rm.pv[0], v};
+    }
+
+   private:
+    OptionsMap                           options;
+    ThreadPool                           threads;
+    TranspositionTable                   tt;
+    Distributed::Node                    cluster{tt};  // Never started
+    Search::SearchManager::UpdateContext updateContext;
+    Search::LimitsType                   limits;
+};
+
+// Plays one game and appends its searched positions to 'entries'. Returns the
+// game result from white's point of view.
+int play_game(Searcher&                 searcher,
+              const GenerateSetup&      setup,
+              uint64_t                  gameIdx,
+              std::vector<PackedEntry>& entries) {
+
+    PRNG         rng((setup.seed ^ (gameIdx * 0x9E3779B97F4A7C15ULL)) | 1);
+    StateListPtr states(new std::deque<StateInfo>(1));
+    Position     pos;
+    Value        result = VALUE_DRAW;  // From the point of view of the side to move at the end
+
+    pos.set(StartFEN, &states->back());
+    searcher.clear();
+
+    const size_t first = entries.size();
+
+    for (int ply = 0; ply < setup.maxPly; ++ply)
+    {
+        Value judged = VALUE_NONE;
+        if (pos.rule_judge(judged))
+        {
+            result = judged;
+            break;
+        }
+
+        MoveList<LEGAL> moves(pos);
+        if (!moves.size())
+        {
+            result = -VALUE_MATE;
+            break;
+        }
+
+        Move m;
+
+        if (ply < setup.randomPlies)
+            m = *(moves.begin() + rng.rand<uint64_t>() % moves.size());
+        else
+        {
+            auto [bestMove, v] = searcher.search(pos, states);
+
+            m = bestMove;
+            entries.push_back({pos.pack(), int16_t(v), m.raw(), 0, {}});
+
+            // A found mate settles the game, there is no need to play it out
+            if (is_decisive(v))
+            {
+                result = v;
+                break;
+            }
+        }
+
+        states->emplace_back();
+        pos.do_move(m, states->back());
+    }
+
+    const Color  last  = pos.side_to_move();
+    const int8_t score = result > VALUE_DRAW ? 1 : result < VALUE_DRAW ? -1 : 0;
+
+    for (size_t i = first; i < entries.size(); ++i)
+        entries[i].result = entries[i].pos.sideToMove == last ? score : -score;
+
+    return last == WHITE ? score : -score;
+}
+
+// Chunks of a batch assigned to one thread. The owner takes them from the
+// front, in file order, so that it mostly searches consecutive positions of
+// the same games and keeps its hash and histories useful. Threads that run out
+// of work steal chunks from the back of the other ranges.
+class ChunkRange {
+   public:
+    void assign(size_t first, size_t last) {
+        std::lock_guard<std::mutex> lk(mutex);
+        begin = first;
+        end   = last;
+    }
+
+    bool pop_front(size_t& chunk) {
+        std::lock_guard<std::mutex> lk(mutex);
+        if (begin == end)
+            return false;
+        chunk = begin++;
+        return true;
+    }
+
+    bool steal_back(size_t& chunk) {
+        std::lock_guard<std::mutex> lk(mutex);
+        if (begin == end)
+            return false;
+        chunk = --end;
+        return true;
+    }
+
+   private:
+    std::mutex mutex;
+    size_t     begin = 0, end = 0;
+};
+
+}  // namespace
+
+
+// Parses the arguments of the 'generate' command, given as pairs of keywords
+// and values, e.g. "generate games 1000 depth 8 concurrency 16 output data.bin".
+GenerateSetup setup_generate(std::istream& is) {
+
+    GenerateSetup setup;
+    std::string   token;
+
+    while (is >> token)
+        if (token == "games")
+            is >> setup.games;
+        else if (token == "depth")
+            is >> setup.depth;
+        else if (token == "nodes")
+            is >> setup.nodes;
+        else if (token == "concurrency")
+            is >> setup.concurrency;
+        else if (token == "random_plies")
+            is >> setup.randomPlies;
+        else if (token == "max_ply")
+            is >> setup.maxPly;
+        else if (token == "hash")
+            is >> setup.hashMB;
+        else if (token == "seed")
+            is >> setup.seed;
+        else if (token == "output")
+            is >> setup.output;
+
+    if (!setup.depth && !setup.nodes)
+        setup.depth = 8;
+
+    if (!setup.seed)
+        setup.seed = uint64_t(now());
+
+    setup.hashMB = std::max(setup.hashMB, size_t(1));
+
+    return setup;
+}
+
+
+// Plays the requested number of games, 'concurrency' of them at the same time,
+// and appends the searched positions to the output file.
+void generate(const GenerateSetup&                           setup,
+              const OptionsMap&                              options,
+              const LazyNumaReplicated<Eval::NNUE::Network>& network) {
+
+    EntryWriter writer(setup.output);
+
+    if (!writer.is_open())
+    {
+        sync_cout << "info string Could not open " << setup.output << " for writing" << sync_endl;
+        return;
+    }
+
+    const size_t concurrency = std::max(setup.concurrency, size_t(1));
+
+    std::atomic<uint64_t>    nextGame = 0, gamesDone = 0;
+    std::atomic<int>         results[3] = {};  // White losses, draws and wins
+    std::mutex               reportMutex;
+    std::vector<std::thread> players;
+
+    const TimePoint start = now();
+
+    for (size_t i = 0; i < concurrency; ++i)
+        players.emplace_back([&]() {
+            Searcher                 searcher(options, network, setup.hashMB, setup.depth,
+                                              setup.nodes);
+            std::vector<PackedEntry> entries;
+
+            for (uint64_t game; (game = nextGame++) < setup.games;)
+            {
+                entries.clear();
+                results[play_game(searcher, setup, game, entries) + 1]++;
+                writer.write(entries);
+
+                const uint64_t done = ++gamesDone;
+
+                if (done % std::max(setup.games / 100, uint64_t(1)) == 0 || done == setup.games)
+                {
+                    std::lock_guard<std::mutex> lk(reportMutex);
+                    const TimePoint elapsed = now() - start + 1;
+
+                    std::cerr << "\rGames: " << done << '/' << setup.games
+                              << ", positions: " << writer.count()
+                              << ", positions/second: " << 1000 * writer.count() / elapsed
+                              << std::flush;
+                }
+            }
+        });
+
+    for (auto& player : players)
+        player.join();
+
+    writer.flush();
+
+    const TimePoint elapsed = now() - start + 1;
+
+    std::cerr << "\n==========================="
+              << "\nGames played       : " << gamesDone
+              << "\nWhite wins         : " << results[2]
+              << "\nDraws              : " << results[1]
+              << "\nBlack wins         : " << results[0]
+              << "\nPositions written  : " << writer.count()
+              << "\nTotal time (ms)    : " << elapsed
+              << "\nPositions/second   : " << 1000 * writer.count() / elapsed
+              << "\nOutput file        : " << setup.output << std::endl;
+}
+
+
+
+// Parses the arguments of the 'rescore' command, the input and output files
+// followed by pairs of keywords and values, e.g. "rescore in.bin out.bin depth 6".
+RescoreSetup setup_rescore(std::istream& is) {
+
+    RescoreSetup setup;
+    std::string  token;
+
+    is >> setup.input >> setup.output;
+
+    while (is >> token)
+        if (token == "depth")
+            is >> setup.depth;
+        else if (token == "nodes")
+            is >> setup.nodes;
+        else if (token == "hash")
+            is >> setup.hashMB;
+
+    if (!setup.depth && !setup.nodes)
+        setup.depth = 6;
+
+    setup.hashMB = std::max(setup.hashMB, size_t(1));
+
+    return setup;
+}
+
+
+// Searches every position of the input file again and writes the entries with
+// the new scores and best moves to the output file, in the same order. The file
+// is processed in batches, each split into chunks among the threads of the pool.
+void rescore(const RescoreSetup&                            setup,
+             const OptionsMap&                              options,
+             ThreadPool&                                    threads,
+             const LazyNumaReplicated<Eval::NNUE::Network>& network) {
+
+    std::ifstream in(setup.input, std::ios::binary);
+    std::ofstream out(setup.output, std::ios::binary | std::ios::trunc);
+
+    if (!in.is_open() || !out.is_open())
+    {
+        sync_cout << "info string Could not open " << (in.is_open() ? setup.output : setup.input)
+                  << sync_endl;
+        return;
+    }
+
+    const size_t numThreads = threads.num_threads();
+
+    // One searcher per thread. Interleaving several per thread in fibers, to
+    // hide the memory latency of one behind the others, was measured slower.
+    std::vector<std::unique_ptr<Searcher>> searchers(numThreads);
+    std::vector<ChunkRange>                ranges(numThreads);
+    std::vector<PackedEntry>               batch(RescoreBatchEntries);
+    uint64_t                               total = 0, rejected = 0;
+
+    const TimePoint start = now();
+
+    while (in)
+    {
+        in.read(reinterpret_cast<char*>(batch.data()),
+                std::streamsize(batch.size() * sizeof(PackedEntry)));
+
+        const size_t read = size_t(in.gcount()) / sizeof(PackedEntry);
+
+        if (!read)
+            break;
+
+        // Corrupt entries are dropped, set_packed() trusts what it is given
+        size_t count = 0;
+        for (size_t k = 0; k < read; ++k)
+            if (is_ok(batch[k].pos))
+                batch[count++] = batch[k];
+
+        rejected += read - count;
+
+        const size_t numChunks = (count + RescoreChunkEntries - 1) / RescoreChunkEntries;
+
+        for (size_t i = 0; i < numThreads; ++i)
+            ranges[i].assign(numChunks * i / numThreads, numChunks * (i + 1) / numThreads);
+
+        for (size_t i = 0; i < numThreads; ++i)
+            threads.run_on_thread(i, [&, i]() {
+                if (!searchers[i])
+                    searchers[i] = std::make_unique<Searcher>(options, network, setup.hashMB,
+                                                              setup.depth, setup.nodes);
+
+                StateListPtr states(new std::deque<StateInfo>(1));
+                Position     pos;
+                size_t       chunk;
+
+                auto next_chunk = [&]() {
+                    if (ranges[i].pop_front(chunk))
+                        return true;
+
+                    for (size_t j = 1; j < numThreads; ++j)
+                        if (ranges[(i + j) % numThreads].steal_back(chunk))
+                            return true;
+
+                    return false;
+                };
+
+                while (next_chunk())
+                    for (size_t k = chunk * RescoreChunkEntries;
+                         k < std::min(count, (chunk + 1) * RescoreChunkEntries); ++k)
+                    {
+                        PackedEntry& e = batch[k];
+
+                        states->resize(1);
+                        pos.set_packed(e.pos, &states->back());
+
+                        // Written back as searched, which lets tests check the round trip
+                        e.pos = pos.pack();
+
+                        if (!MoveList<LEGAL>(pos).size())
+                        {
+                            e.score = int16_t(-VALUE_MATE);
+                            e.move  = Move::none().raw();
+                            continue;
+                        }
+
+                        auto [m, v] = searchers[i]->search(pos, states);
+
+                        e.score = int16_t(v);
+                        e.move  = m.raw();
+                    }
+            });
+
+        for (size_t i = 0; i < numThreads; ++i)
+            threads.wait_on_thread(i);
+
+        out.write(reinterpret_cast<const char*>(batch.data()),
+                  std::streamsize(count * sizeof(PackedEntry)));
+
+        total += count;
+
+        const TimePoint elapsed = now() - start + 1;
+
+        std::cerr << "\rPositions: " << total << ", positions/second: " << 1000 * total / elapsed
+                  << std::flush;
+    }
+
+    // The searchers must be released while the pool threads are idle
+    searchers.clear();
+    out.flush();
+
+    const TimePoint elapsed = now() - start + 1;
+
+    std::cerr << "\n==========================="
+              << "\nPositions rescored : " << total
+              << "\nPositions rejected : " << rejected
+              << "\nTotal time (ms)    : " << elapsed
+              << "\nPositions/second   : " << 1000 * total / elapsed
+              << "\nOutput file        : " << setup.output << std::endl;
+}
+
+}  // namespace Stockfish::TrainingData
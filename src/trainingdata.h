@@ -0,0 +1,89 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2025 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRAININGDATA_H_INCLUDED
+#define TRAININGDATA_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+#include "nnue/network.h"
+#include "numa.h"
+#include "position.h"
+#include "types.h"
+
+namespace Stockfish {
+
+class OptionsMap;
+class ThreadPool;
+
+namespace TrainingData {
+
+// One record of a training data file. Score and result are from the point of
+// view of the side to move, the result being 1 for a win, 0 for a draw and -1
+// for a loss.
+struct PackedEntry {
+    PackedPosition pos;
+    std::int16_t   score;
+    std::uint16_t  move;
+    std::int8_t    result;
+    std::uint8_t   padding[3];
+};
+
+static_assert(sizeof(PackedEntry) == 40, "PackedEntry must be 40 bytes");
+
+struct GenerateSetup {
+    std::uint64_t games       = 100;
+    Depth         depth       = 0;
+    std::uint64_t nodes       = 0;
+    size_t        concurrency = 0;
+    int           randomPlies = 8;
+    int           maxPly      = 400;
+    size_t        hashMB      = 16;
+    std::uint64_t seed        = 0;
+    std::string   output      = "generated.bin";
+};
+
+GenerateSetup setup_generate(std::istream&);
+
+void generate(const GenerateSetup&,
+              const OptionsMap&,
+              const LazyNumaReplicated<Eval::NNUE::Network>&);
+
+struct RescoreSetup {
+    std::string   input;
+    std::string   output;
+    Depth         depth  = 0;
+    std::uint64_t nodes  = 0;
+    size_t        hashMB = 16;
+};
+
+RescoreSetup setup_rescore(std::istream&);
+
+void rescore(const RescoreSetup&,
+             const OptionsMap&,
+             ThreadPool&,
+             const LazyNumaReplicated<Eval::NNUE::Network>&);
+
+}  // namespace TrainingData
+
+}  // namespace Stockfish
+
+#endif  // #ifndef TRAININGDATA_H_INCLUDED
@@ -18,17 +18,28 @@
 
 #include "tt.h"
 
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <iostream>
+#include <thread>
 
 #include "memory.h"
 #include "misc.h"
 #include "thread.h"
 
+#ifdef TT_PROBE_STATS
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+    #endif
+#endif
+
 namespace Stockfish {
 
 
@@ -140,21 +151,69 @@ void TTWriter::write(
 static constexpr int ClusterSize = 3;
 
 struct Cluster {
-    TTEntry entry[ClusterSize];
-    char    padding[2];  // Pad to 32 bytes
+    TTEntry  entry[ClusterSize];
+    uint16_t epoch16;  // Value of TranspositionTable::epoch16 when last written, pads to 32 bytes
 };
 
 static_assert(sizeof(Cluster) == 32, "Suboptimal Cluster size");
 
 
+// A table shared between processes follows this header in the shared memory
+// segment, which holds the counters that all the processes must agree on.
+struct alignas(64) TranspositionTable::SharedHeader {
+    std::atomic<uint64_t> magic;  // Set once the segment is ready
+    uint64_t              clusterCount;
+    std::atomic<uint8_t>  generation8;
+    std::atomic<uint16_t> epoch16;
+};
+
+// Identifies the layout of the segment, to be changed along with Cluster
+static constexpr uint64_t SharedMagic = 0x5454'4148'5346'0001;
+
+// Longest wait for another process to set up the segment, zeroing included
+static constexpr int SharedSetupMs = 10000;
+
+#ifdef TT_PROBE_STATS
+
+// Times the first load of a cluster in a probe with the time stamp counter, and
+// counts with dbg_hit_on() the probes that missed the L2 cache (slot 0) and the
+// L3 cache (slot 1). The thresholds, in reference cycles and including the cost
+// of the measure, only tell apart the latencies of the cache levels roughly and
+// should be adjusted to the machine.
+static constexpr uint64_t L2Cycles = 250, L3Cycles = 700;
+
+static void time_cluster_load(const Cluster* cluster) {
+
+    _mm_lfence();
+    const uint64_t start = __rdtsc();
+    _mm_lfence();
+
+    [[maybe_unused]] volatile uint16_t epoch = cluster->epoch16;
+
+    _mm_lfence();
+    const uint64_t cycles = __rdtsc() - start;
+
+    dbg_hit_on(cycles > L2Cycles, 0);
+    dbg_hit_on(cycles > L3Cycles, 1);
+}
+
+#endif
+
+
 // Sets the size of the transposition table,
 // measured in megabytes. Transposition table consists
 // of clusters and each cluster consists of ClusterSize number of TTEntry.
-void TranspositionTable::resize(size_t mbSize, ThreadPool& threads) {
-    aligned_large_pages_free(table);
+void TranspositionTable::resize(size_t             mbSize,
+                                ThreadPool&        threads,
+                                const std::string& sharedName,
+                                bool               deferZeroing) {
+    release();
 
     clusterCount = mbSize * 1024 * 1024 / sizeof(Cluster);
 
+    if (!sharedName.empty() && map_shared(sharedName, threads))
+        return;
+
     table = static_cast<Cluster*>(aligned_large_pages_alloc(clusterCount * sizeof(Cluster)));
 
     if (!table)
@@ -163,16 +222,131 @@ void TranspositionTable::resize(size_t mbSize, ThreadPool& threads) {
         exit(EXIT_FAILURE);
     }
 
-    clear(threads);
+    zeroPending = deferZeroing;
+    if (!zeroPending)
+        zero_fill(threads);
 }
 
 
-// Initializes the entire transposition table to zero,
-// in a multi-threaded way.
+// Zeroes the table if resize() was asked to defer it, before the first search
+void TranspositionTable::ensure_zeroed(ThreadPool& threads) {
+    if (zeroPending)
+        zero_fill(threads);
+}
+
+
+// Maps the table from the named shared memory segment, which is created with
+// the requested size if no other process did it, else keeps the size chosen by
+// its creator. Entries are then written by the threads of all the processes,
+// with the same races as between the threads of one process. Returns false,
+// the table being private to the process, if the segment cannot be used.
+bool TranspositionTable::map_shared(const std::string& name, ThreadPool& threads) {
+
+    static_assert(sizeof(SharedHeader) == 64, "Header must keep the clusters aligned");
+    static_assert(std::atomic<uint16_t>::is_always_lock_free
+                    && std::atomic<uint64_t>::is_always_lock_free,
+                  "Only lock-free atomics are shared");
+
+    // The header takes the place of some clusters, not to round the segment up
+    clusterCount -= sizeof(SharedHeader) / sizeof(Cluster);
+
+    size_t size = sizeof(SharedHeader) + clusterCount * sizeof(Cluster);
+    bool   created;
+    void*  mem = shared_memory_map(name, size, created);
+
+    // Processes started together race to create the segment, and the losers
+    // may find it still empty.
+    for (int ms = 0; !mem && !created && ms < SharedSetupMs; ms += 10)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        mem = shared_memory_map(name, size, created);
+    }
+
+    if (!mem)
+    {
+        std::cerr << "Failed to map shared hash " << name << ", using a private one." << std::endl;
+        return false;
+    }
+
+    shared = static_cast<SharedHeader*>(mem);
+    table  = reinterpret_cast<Cluster*>(shared + 1);
+
+    if (created)
+    {
+        zero_fill(threads);
+        shared->clusterCount = clusterCount;
+        shared->magic.store(SharedMagic, std::memory_order_release);
+        return true;
+    }
+
+    // Its creator may still be zeroing it
+    for (int ms = 0; ms < SharedSetupMs; ms += 10)
+    {
+        if (shared->magic.load(std::memory_order_acquire) == SharedMagic)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    if (shared->magic != SharedMagic
+        || sizeof(SharedHeader) + shared->clusterCount * sizeof(Cluster) > size)
+    {
+        std::cerr << "Shared hash " << name << " is not a transposition table, using a private one."
+                  << std::endl;
+        release();
+        return false;
+    }
+
+    clusterCount = shared->clusterCount;
+    generation8  = shared->generation8;
+    epoch16      = shared->epoch16;
+    return true;
+}
+
+
+void TranspositionTable::release() {
+    if (shared)
+        shared_memory_unmap(shared);
+    else
+        aligned_large_pages_free(table);
+
+    // A zeroing deferred by resize() was for the memory just released
+    shared      = nullptr;
+    table       = nullptr;
+    zeroPending = false;
+}
+
+
+// Empties the transposition table. Every cluster remembers the epoch in which
+// it was last written, so starting a new epoch invalidates the whole table at
+// once without touching its memory, and stale clusters are reset lazily by
+// probe(). The table is only zeroed when the epoch counter wraps around.
 void TranspositionTable::clear(ThreadPool& threads) {
+    generation8 = 0;
+    epoch16     = shared ? uint16_t(++shared->epoch16) : uint16_t(epoch16 + 1);
+
+    if (shared)
+        shared->generation8 = 0;
+
+    if (epoch16 == 0)
+        zero_fill(threads);
+}
+
+
+// Initializes the entire transposition table to zero, in a multi-threaded way.
+// This is also where the memory gets first touched after an allocation, which
+// decides on which NUMA node its pages are placed.
+void TranspositionTable::zero_fill(ThreadPool& threads) {
     generation8              = 0;
+    epoch16                  = 0;
+    zeroPending              = false;
     const size_t threadCount = threads.num_threads();
 
+    if (shared)
+    {
+        shared->generation8 = 0;
+        shared->epoch16     = 0;
+    }
+
     for (size_t i = 0; i < threadCount; ++i)
     {
         threads.run_on_thread(i, [this, i, threadCount]() {
@@ -197,17 +371,36 @@ int TranspositionTable::hashfull(int maxAge) const {
     int maxAgeInternal = maxAge << GENERATION_BITS;
     int cnt            = 0;
     for (int i = 0; i < 1000; ++i)
+    {
+        if (table[i].epoch16 != epoch16)
+            continue;
+
         for (int j = 0; j < ClusterSize; ++j)
             cnt += table[i].entry[j].is_occupied()
                 && table[i].entry[j].relative_age(generation8) <= maxAgeInternal;
+    }
 
     return cnt / ClusterSize;
 }
 
 
 void TranspositionTable::new_search() {
-    // increment by delta to keep lower bits as is
-    generation8 += GENERATION_DELTA;
+    if (!shared)
+    {
+        // increment by delta to keep lower bits as is
+        generation8 += GENERATION_DELTA;
+        return;
+    }
+
+    // A shared table ages once for the searches that the processes start on the
+    // same root: the first one moves the generation on and the others follow it.
+    uint8_t current = shared->generation8;
+    uint8_t next    = uint8_t(current + GENERATION_DELTA);
+    if (current == generation8 && shared->generation8.compare_exchange_strong(current, next))
+        current += GENERATION_DELTA;
+
+    generation8 = current;
+    epoch16     = shared->epoch16;
 }
 
 
@@ -222,7 +415,21 @@ uint8_t TranspositionTable::generation() const { return generation8; }
 // TTEntry t2 if its replace value is greater than that of t2.
 std::tuple<bool, TTData, TTWriter> TranspositionTable::probe(const Key key) const {
 
-    TTEntry* const tte   = first_entry(key);
+    Cluster* const cluster = &table[mul_hi64(key, clusterCount)];
+
+#ifdef TT_PROBE_STATS
+    time_cluster_load(cluster);
+#endif
+
+    // Reset a cluster left over from before the last clear(), the race with other
+    // threads doing the same is harmless.
+    if (cluster->epoch16 != epoch16)
+    {
+        std::memset(cluster->entry, 0, sizeof(cluster->entry));
+        cluster->epoch16 = epoch16;
+    }
+
+    TTEntry* const tte   = cluster->entry;
     const uint16_t key16 = uint16_t(key);  // Use the low 16 bits as key inside the cluster
 
     for (int i = 0; i < ClusterSize; ++i)
@@ -248,4 +455,9 @@ TTEntry* TranspositionTable::first_entry(const Key key) const {
     return &table[mul_hi64(key, clusterCount)].entry[0];
 }
 
+
+std::string TranspositionTable::memory_backing() const {
+    return shared ? "shared, " + large_pages_backing(shared) : large_pages_backing(table);
+}
+
 }  // namespace Stockfish
@@ -21,6 +21,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
 #include <tuple>
 
 #include "memory.h"
@@ -78,10 +79,16 @@ struct TTWriter {
 class TranspositionTable {
 
    public:
-    ~TranspositionTable() { aligned_large_pages_free(table); }
-
-    void resize(size_t mbSize, ThreadPool& threads);  // Set TT size
-    void clear(ThreadPool& threads);                  // Re-initialize memory, multithreaded
+    ~TranspositionTable() { release(); }
+
+    // Set TT size, the table being shared with other processes if given the name of a
+    // shared memory segment. Zeroing a private table may be deferred to ensure_zeroed().
+    void resize(size_t             mbSize,
+                ThreadPool&        threads,
+                const std::string& sharedName   = "",
+                bool               deferZeroing = false);
+    void ensure_zeroed(ThreadPool& threads);          // Zero the table if resize() deferred it
+    void clear(ThreadPool& threads);                  // Invalidate all entries lazily
     int  hashfull(int maxAge = 0)
       const;  // Approximate what fraction of entries (permille) have been written to during this root search
 
@@ -92,14 +99,24 @@ class TranspositionTable {
     probe(const Key key) const;  // The main method, whose retvals separate local vs global objects
     TTEntry* first_entry(const Key key)
       const;  // This is the hash function; its only external use is memory prefetching.
+    std::string memory_backing() const;  // Which pages back the table, for diagnostics
 
    private:
     friend struct TTEntry;
 
-    size_t   clusterCount;
-    Cluster* table = nullptr;
+    struct SharedHeader;
+
+    void zero_fill(ThreadPool& threads);  // Re-initialize memory, multithreaded
+    bool map_shared(const std::string& name, ThreadPool& threads);
+    void release();
+
+    size_t        clusterCount;
+    Cluster*      table  = nullptr;
+    SharedHeader* shared = nullptr;  // Set when the table lives in shared memory
 
-    uint8_t generation8 = 0;  // Size must be not bigger than TTEntry::genBound8
+    uint8_t  generation8 = 0;  // Size must be not bigger than TTEntry::genBound8
+    uint16_t epoch16     = 0;  // Incremented by clear(), size must match Cluster::epoch16
+    bool     zeroPending = false;
 };
 
 }  // namespace Stockfish
@@ -35,6 +35,22 @@
 //
 // -DUSE_PEXT    | Add runtime support for use of pext asm-instruction. Works
 //               | only in 64-bit mode and requires hardware with pext support.
+//
+// -DTT_PROBE_STATS | Count the transposition table probes missing the L2 and
+//                  | L3 caches, printed by dbg_print(). Only for x86-64.
+//
+// -DMOVEPICK_STATS | Measure the cycles spent scoring and sorting the quiet
+//                  | moves, printed by dbg_print(). Only for x86-64.
+//
+// -DATTACK_MAPS | Maintain the squares attacked by each piece type of both
+//               | sides in do_move(), instead of computing them on demand.
+//               | About 3% slower in bench and a third slower in perft, so
+//               | off by default. Built and checked by the Variants workflow.
+//
+// -DCOPY_MAKE | Keep the piece placement in StateInfo, copied by do_move()
+//             | and dropped by undo_move(), instead of updating it in place.
+//             | A quarter slower in perft and even in bench, so off by
+//             | default. Built and checked by the Variants workflow.
 
     #include <cassert>
     #include <cstdint>
@@ -22,6 +22,7 @@
 #include <cmath>
 #include <functional>
 #include <iterator>
+#include <map>
 #include <optional>
 #include <sstream>
 #include <string_view>
@@ -62,8 +63,8 @@ void UCIEngine::print_info_string(std::string_view str) {
     sync_cout_end();
 }
 
-UCIEngine::UCIEngine(int argc, char** argv) :
-    engine(argv[0]),
+UCIEngine::UCIEngine(int argc, char** argv, bool fastStart) :
+    engine(argv[0], fastStart),
     cli(argc, argv) {
 
     engine.get_options().add_info_listener([](const std::optional<std::string>& str) {
@@ -72,6 +73,8 @@ UCIEngine::UCIEngine(int argc, char** argv) :
     });
 
     init_search_update_listeners();
+
+    print_info_string(engine.large_pages_information_as_string());
 }
 
 void UCIEngine::init_search_update_listeners() {
@@ -101,7 +104,11 @@ void UCIEngine::loop() {
         is >> std::skipws >> token;
 
         if (token == "quit" || token == "stop")
+        {
             engine.stop();
+            if (workers)
+                workers->stop();
+        }
 
         // The GUI sends 'ponderhit' to tell that the user has played the expected move.
         // So, 'ponderhit' is sent if pondering was done on the same move that the user
@@ -134,7 +141,10 @@ void UCIEngine::loop() {
         else if (token == "ucinewgame")
             engine.search_clear();
         else if (token == "isready")
+        {
+            engine.ensure_ready();
             sync_cout << "readyok" << sync_endl;
+        }
 
         // Add custom non-UCI commands, mainly for debugging purposes.
         // These commands must not be used during a search!
@@ -144,6 +154,20 @@ void UCIEngine::loop() {
             bench(is);
         else if (token == BenchmarkCommand)
             benchmark(is);
+        else if (token == "setupbench")
+            Benchmark::setup_throughput(is);
+        else if (token == "generate")
+            engine.generate(TrainingData::setup_generate(is));
+        else if (token == "rescore")
+            engine.rescore(TrainingData::setup_rescore(is));
+        else if (token == "tbgen")
+        {
+            std::string signature, directory;
+            is >> std::skipws >> signature >> directory;
+            engine.generate_tablebase(signature, directory);
+        }
+        else if (token == "coordinate")
+            coordinate(is);
         else if (token == "d")
             sync_cout << engine.visualize() << sync_endl;
         else if (token == "eval")
@@ -172,6 +196,8 @@ void UCIEngine::loop() {
                       << sync_endl;
 
     } while (token != "quit" && cli.argc == 1);  // The command-line arguments are one-shot
+
+    wait_for_coordinator();
 }
 
 Search::LimitsType UCIEngine::parse_limits(std::istream& is) {
@@ -223,6 +249,89 @@ void UCIEngine::go(std::istringstream& is) {
         engine.go(limits);
 }
 
+// Searches the current position in several engine processes sharing the
+// transposition table, and plays the move they vote for, each with the depth
+// it completed. The processes search in the background, so that the search can
+// be stopped like the one of go, but it must have limits all the same.
+void UCIEngine::coordinate(std::istringstream& is) {
+
+    size_t      processes = 0;
+    std::string goArgs;
+
+    is >> processes;
+    std::getline(is, goArgs);
+
+    std::istringstream       goStream(goArgs);
+    const Search::LimitsType limits = parse_limits(goStream);
+
+    if (!processes || limits.infinite || limits.ponderMode || limits.perft
+        || !(limits.use_time_management() || limits.movetime || limits.depth || limits.nodes
+             || limits.mate))
+    {
+        sync_cout << "info string Usage: coordinate <processes> <limited go parameters>"
+                  << sync_endl;
+        return;
+    }
+
+    wait_for_coordinator();
+
+    const auto&              options    = engine.get_options();
+    const std::string        sharedHash = options["SharedHash"];
+    std::vector<std::string> commands;
+
+    // The processes get the options of this one, except those naming resources
+    // only one process can use. Unless this process shares its table, they
+    // share one of their own, which lasts until the last of them quits.
+    for (const auto& [name, value] : options.non_default())
+        if (name != "SharedHash" && name != "ClusterPort" && name != "Debug Log File")
+            commands.push_back("setoption name " + name + " value " + value);
+
+    commands.push_back("setoption name SharedHash value "
+                       + (sharedHash.empty() ? MultiProcess::private_shared_hash_name()
+                                             : sharedHash));
+    commands.push_back(engine.position_command());
+    commands.push_back("go" + goArgs);
+
+    workers     = std::make_unique<MultiProcess::Workers>(cli.argv[0], processes, commands);
+    coordinator = std::thread([this] {
+        const auto answers = workers->wait();
+
+        std::map<std::string, int>  votes;
+        const MultiProcess::Answer* best = nullptr;
+
+        for (size_t i = 0; i < answers.size(); ++i)
+        {
+            const auto& answer = answers[i];
+
+            if (answer.bestmove.empty())
+            {
+                sync_cout << "info string Process " << i + 1 << " failed" << sync_endl;
+                continue;
+            }
+
+            sync_cout << "info string Process " << i + 1 << " bestmove " << answer.bestmove
+                      << " depth " << answer.depth << sync_endl;
+
+            votes[answer.bestmove] += answer.depth + 1;
+            if (!best || votes[answer.bestmove] > votes[best->bestmove])
+                best = &answer;
+        }
+
+        if (best)
+            on_bestmove(best->bestmove, best->ponder);
+        else
+            on_bestmove("(none)", "");
+    });
+}
+
+void UCIEngine::wait_for_coordinator() {
+
+    if (coordinator.joinable())
+        coordinator.join();
+
+    workers.reset();
+}
+
 void UCIEngine::bench(std::istream& args) {
     std::string token;
     uint64_t    num, nodes = 0, cnt = 1;
@@ -299,8 +408,12 @@ void UCIEngine::benchmark(std::istream& args) {
     std::string token;
     uint64_t    nodes = 0, cnt = 1;
     uint64_t    nodesSearched = 0;
+    int         depthReached  = 0;
 
-    engine.set_on_update_full([&](const Engine::InfoFull& i) { nodesSearched = i.nodes; });
+    engine.set_on_update_full([&](const Engine::InfoFull& i) {
+        nodesSearched = i.nodes;
+        depthReached  = i.depth;
+    });
 
     engine.set_on_iter([](const auto&) {});
     engine.set_on_update_no_moves([](const auto&) {});
@@ -360,6 +473,9 @@ void UCIEngine::benchmark(std::istream& args) {
     cnt   = 1;
     nodes = 0;
 
+    uint64_t totalDepth = 0, totalDuplicateWork = 0;
+    int64_t  totalBestmoveLatency = 0, maxBestmoveLatency = 0;
+
     int           numHashfullReadings = 0;
     constexpr int hashfullAges[]      = {0, 999};  // Only normal hashfull and touched hash.
     int           totalHashfull[std::size(hashfullAges)] = {0};
@@ -400,6 +516,12 @@ void UCIEngine::benchmark(std::istream& args) {
 
             updateHashfullReadings();
 
+            totalDepth += depthReached;
+            totalDuplicateWork += engine.get_duplicate_root_work();
+
+            totalBestmoveLatency += engine.get_bestmove_latency();
+            maxBestmoveLatency = std::max(maxBestmoveLatency, engine.get_bestmove_latency());
+
             nodes += nodesSearched;
             nodesSearched = 0;
         }
@@ -440,11 +562,17 @@ void UCIEngine::benchmark(std::istream& args) {
               << "\nThread count               : " << setup.threads
               << "\nThread binding             : " << threadBinding
               << "\nTT size [MiB]              : " << setup.ttSize
+              << "\nTT backing                 : " << engine.get_hash_backing()
+              << "\nNetwork backing            : " << engine.get_network_backing()
               << "\nHash max, avg [per mille]  : "
               << "\n    single search          : " << maxHashfull[0] << ", "
               << totalHashfull[0] / numHashfullReadings
               << "\n    single game            : " << maxHashfull[1] << ", "
               << totalHashfull[1] / numHashfullReadings
+              << "\nAverage depth reached      : " << double(totalDepth) / numGoCommands
+              << "\nDuplicate root work [%]    : " << totalDuplicateWork / 10.0 / numGoCommands
+              << "\nBestmove latency max, avg  : " << maxBestmoveLatency << ", "
+              << totalBestmoveLatency / numGoCommands << " us"
               << "\nTotal nodes searched       : " << nodes
               << "\nTotal search time [s]      : " << totalTime / 1000.0
               << "\nNodes/second               : " << 1000 * nodes / totalTime << std::endl;
@@ -583,11 +711,24 @@ std::string UCIEngine::move(Move m) {
 }
 
 Move UCIEngine::to_move(const Position& pos, std::string str) {
-    for (const auto& m : MoveList<LEGAL>(pos))
-        if (str == move(m))
-            return m;
+    if (str.length() != 4)
+        return Move::none();
+
+    auto to_square = [](char f, char r) {
+        return f >= 'a' && f <= 'i' && r >= '0' && r <= '9'
+               ? make_square(File(f - 'a'), Rank(r - '0'))
+               : SQ_NONE;
+    };
+
+    Square from = to_square(str[0], str[1]);
+    Square to   = to_square(str[2], str[3]);
+
+    if (from == SQ_NONE || to == SQ_NONE || from == to)
+        return Move::none();
 
-    return Move::none();
+    // Validate the move on the board instead of generating all the legal moves
+    Move m(from, to);
+    return pos.pseudo_legal(m) && pos.legal(m) ? m : Move::none();
 }
 
 void UCIEngine::on_update_no_moves(const Engine::InfoShort& info) {
@@ -21,11 +21,14 @@
 
 #include <cstdint>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <string_view>
+#include <thread>
 
 #include "engine.h"
 #include "misc.h"
+#include "multiprocess.h"
 #include "search.h"
 
 namespace Stockfish {
@@ -38,7 +41,7 @@ using Value = int;
 
 class UCIEngine {
    public:
-    UCIEngine(int argc, char** argv);
+    UCIEngine(int argc, char** argv, bool fastStart = false);
 
     void loop();
 
@@ -57,9 +60,14 @@ class UCIEngine {
     Engine      engine;
     CommandLine cli;
 
+    std::unique_ptr<MultiProcess::Workers> workers;  // Of the running coordinate command
+    std::thread                            coordinator;
+
     static void print_info_string(std::string_view str);
 
     void          go(std::istringstream& is);
+    void          coordinate(std::istringstream& is);
+    void          wait_for_coordinator();
     void          bench(std::istream& args);
     void          benchmark(std::istream& args);
     void          position(std::istringstream& is);
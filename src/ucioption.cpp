@@ -83,8 +83,52 @@ void OptionsMap::add(const std::string& name, const Option& option) {
 }
 
 
+void OptionsMap::add_copies(const OptionsMap& other) {
+
+    std::vector<const OptionsStore::value_type*> added;
+
+    for (const auto& it : other.options_map)
+        added.push_back(&it);
+
+    std::sort(added.begin(), added.end(),
+              [](const auto* a, const auto* b) { return a->second.idx < b->second.idx; });
+
+    for (const auto* it : added)
+    {
+        Option o    = it->second;
+        o.on_change = nullptr;
+        add(it->first, o);
+    }
+}
+
+
 std::size_t OptionsMap::count(const std::string& name) const { return options_map.count(name); }
 
+std::vector<std::pair<std::string, std::string>> OptionsMap::non_default() const {
+
+    std::vector<const OptionsStore::value_type*>     added;
+    std::vector<std::pair<std::string, std::string>> changed;
+
+    for (const auto& it : options_map)
+        added.push_back(&it);
+
+    std::sort(added.begin(), added.end(),
+              [](const auto* a, const auto* b) { return a->second.idx < b->second.idx; });
+
+    for (const auto* it : added)
+    {
+        const Option& o = it->second;
+
+        // The default of a combo is not kept, so it is always included
+        if (o.type != "button"
+            && (o.type == "spin" ? std::stof(o.currentValue) != std::stof(o.defaultValue)
+                                 : o.currentValue != o.defaultValue))
+            changed.emplace_back(it->first, o.currentValue);
+    }
+
+    return changed;
+}
+
 Option::Option(const OptionsMap* map) :
     parent(map) {}
 
@@ -25,6 +25,8 @@
 #include <map>
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace Stockfish {
 // Define a custom comparator, because the UCI options should be case-insensitive
@@ -87,8 +89,16 @@ class OptionsMap {
 
     void add(const std::string&, const Option& option);
 
+    // Adds the options of another map with their current values, but without
+    // their actions on change, which belong to the owner of that map
+    void add_copies(const OptionsMap&);
+
     std::size_t count(const std::string&) const;
 
+    // The names and values of the options changed from their defaults, in the
+    // order the options were added
+    std::vector<std::pair<std::string, std::string>> non_default() const;
+
    private:
     friend class Engine;
     friend class Option;
@@ -0,0 +1,72 @@
+#!/bin/bash
+# verify that instances on localhost cooperate in cluster mode
+
+error()
+{
+  echo "cluster testing failed on line $1"
+  kill $(jobs -p) 2> /dev/null
+  exit 1
+}
+trap 'error ${LINENO}' ERR
+
+echo "cluster testing started"
+
+ports="23451 23452 23453"
+
+# each instance listens on its port and sends to the others
+for port in $ports
+do
+  peers=`echo $ports | tr ' ' '\n' | grep -v $port | sed 's/^/127.0.0.1:/' | paste -sd,`
+
+  rm -f cluster_in_$port
+  mkfifo cluster_in_$port
+  ./pikafish < cluster_in_$port > cluster_out_$port 2>&1 &
+  exec {fd}> cluster_in_$port
+  eval "fd_$port=$fd"
+
+  echo "setoption name ClusterSecret value cluster-test" >&$fd
+  echo "setoption name ClusterPort value $port" >&$fd
+  echo "setoption name ClusterPeers value $peers" >&$fd
+  echo "setoption name ClusterMinDepth value 4" >&$fd
+done
+
+# let all the instances listen before searching
+sleep 2
+
+for port in $ports
+do
+  fd_var=fd_$port
+  echo "position startpos" >&${!fd_var}
+  echo "go depth 14" >&${!fd_var}
+done
+
+for port in $ports
+do
+  for i in `seq 1 120`
+  do
+    grep -q "^bestmove" cluster_out_$port && break
+    sleep 1
+  done
+done
+
+# quit only once all are done, so that all the peers stay connected
+for port in $ports
+do
+  fd_var=fd_$port
+  echo "quit" >&${!fd_var}
+  eval "exec ${!fd_var}>&-"
+done
+
+wait
+
+for port in $ports
+do
+  # every instance must have received entries from its peers, and voted a move
+  grep "info string Cluster:" cluster_out_$port
+  grep "info string Cluster:" cluster_out_$port | awk '{if ($13 == 0 || $4 != 2) exit(1)}'
+  grep -q "^bestmove" cluster_out_$port
+done
+
+rm -f cluster_in_* cluster_out_*
+
+echo "cluster testing OK"
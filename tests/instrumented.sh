@@ -296,6 +296,33 @@ do
 
 done
 
+# training data round trip: the positions of generated games, set up and packed
+# again by rescore, must give back the same FENs
+cat << EOF > packed_fens.py
+import re, sys
+data = open(sys.argv[1], 'rb').read()
+for i in range(0, len(data), 40):
+    occupied = int.from_bytes(data[i:i + 12], 'little')
+    pieces, n, squares = data[i + 12:i + 28], 0, ['1'] * 90
+    for s in range(90):
+        if occupied >> s & 1:
+            squares[s] = ' RACPNBK racpnbk'[pieces[n // 2] >> 4 * (n % 2) & 15]
+            n += 1
+    rows = [''.join(squares[9 * r:9 * r + 9]) for r in range(9, -1, -1)]
+    board = re.sub('1+', lambda m: str(len(m.group())), '/'.join(rows))
+    side, ply = data[i + 28], int.from_bytes(data[i + 30:i + 32], 'little')
+    print(board, 'wb'[side], '- -', data[i + 29], 1 + (ply - side) // 2)
+EOF
+
+eval "$prefix $exeprefix ./pikafish generate games 4 depth 3 seed 1 output generated.bin $postfix"
+eval "$prefix $exeprefix ./pikafish rescore generated.bin rescored.bin depth 3 $postfix"
+python3 packed_fens.py generated.bin > generated.fens
+python3 packed_fens.py rescored.bin > rescored.fens
+test -s generated.fens
+diff generated.fens rescored.fens
+
+rm -f packed_fens.py generated.bin rescored.bin generated.fens rescored.fens
+
 rm -f tsan.supp bench_tmp.epd
 
 echo "instrumented testing OK"
\ No newline at end of file
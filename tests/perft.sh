@@ -1,5 +1,5 @@
 #!/bin/bash
-# verify perft numbers (positions from https://www.chessprogramming.org/Perft_Results)
+# verify perft numbers (start position, and positions with the side to move in double check)
 
 error()
 {
@@ -11,21 +11,24 @@ trap 'error ${LINENO}' ERR
 echo "perft testing started"
 
 cat << EOF > perft.exp
-   set timeout 10
+   set timeout 30
    lassign \$argv pos depth result
-   spawn ./stockfish
+   spawn ./pikafish
    send "position \$pos\\ngo perft \$depth\\n"
    expect "Nodes searched? \$result" {} timeout {exit 1}
    send "quit\\n"
    expect eof
 EOF
 
-expect perft.exp startpos 5 4865609 > /dev/null
-expect perft.exp "fen r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -" 5 193690690 > /dev/null
-expect perft.exp "fen 8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -" 6 11030083 > /dev/null
-expect perft.exp "fen r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1" 5 15833292 > /dev/null
-expect perft.exp "fen rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8" 5 89941194 > /dev/null
-expect perft.exp "fen r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10" 5 164075551 > /dev/null
+expect perft.exp startpos 5 133312995 > /dev/null
+expect perft.exp "fen 2bk5/4a4/3P5/8p/4C1p1P/9/7c1/B4c3/5r3/3A1K3 w - - 3 88" 5 1270116 > /dev/null
+expect perft.exp "fen 1nba1ab1r/4k4/c4C3/2p1p3p/p8/3n1Np2/2P1P3P/5C1R1/cr3K3/1NBA1AB2 w - - 20 27" 5 4469176 > /dev/null
+expect perft.exp "fen rnba1k3/4a3r/4b2cn/C1P6/8P/P3pR3/4P1P2/N4C3/9/RcBAKAB2 b - - 6 19" 5 8720951 > /dev/null
+expect perft.exp "fen r1ba1kb1r/4a4/5R3/5C2P/2c6/4P1p2/3p5/B2A4B/4AK2R/7N1 b - - 4 66" 5 2024679 > /dev/null
+expect perft.exp "fen 1CR1ka3/4ar3/3cb3b/8n/2N6/p1p4p1/3Np4/3A5/2RKA4/2B3B2 b - - 14 73" 5 2322378 > /dev/null
+expect perft.exp "fen Nnba1ab2/4k4/9/1P5nr/5P3/2C3pp1/6c1c/3r1A3/4RK1R1/4CABN1 b - - 7 66" 5 17392160 > /dev/null
+expect perft.exp "fen 4R4/4nk3/3a3rb/c5p2/5P3/P1p3P2/9/5A3/3K3rc/1NB2A3 w - - 28 81" 5 3288623 > /dev/null
+expect perft.exp "fen 2bakab2/9/4c4/6p2/2p1p2np/1p4B2/2R3n1P/1r1AK1N1r/R1C2N3/2B2A3 w - - 0 55" 5 1617213 > /dev/null
 
 rm perft.exp
 